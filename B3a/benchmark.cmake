@@ -0,0 +1,72 @@
+#----------------------------------------------------------------------------
+# Throughput benchmark of exampleB3a, run by the 'benchmark' target:
+#   cmake -DEXE=<exampleB3a> [-DTHREADS="1;2;4"] [-DSCALE=1]
+#         [-DOUTPUT=benchmark.jsonl] -P benchmark.cmake
+#
+# Runs the reference configurations at 1, 2, 4, ... up to the number of
+# logical cores (or at THREADS), and appends to OUTPUT one JSON line per
+# run with the events/s, the initialization times, the peak RSS and the
+# output size (exampleB3a --stats). SCALE multiplies the numbers of events.
+#
+#   emy      : FTFP_BERT_EMY with region de-excitation (MoSolution, Detector)
+#   emy_deex : FTFP_BERT_EMY with full-world de-excitation (fluo, Auger, PIXE)
+#   geantino : geantino transport only, geometry and navigation cost
+#   mo       : high-statistics run of the Mo setup with the EM-only
+#              livermore list, to compare with emy
+#
+if(NOT EXE)
+  message(FATAL_ERROR "benchmark.cmake: EXE, the exampleB3a program, is not set")
+endif()
+if(NOT OUTPUT)
+  set(OUTPUT benchmark.jsonl)
+endif()
+if(NOT SCALE)
+  set(SCALE 1)
+endif()
+if(NOT THREADS)
+  cmake_host_system_information(RESULT _cores QUERY NUMBER_OF_LOGICAL_CORES)
+  set(THREADS)
+  set(_n 1)
+  while(_n LESS _cores)
+    list(APPEND THREADS ${_n})
+    math(EXPR _n "${_n} * 2")
+  endwhile()
+  list(APPEND THREADS ${_cores})
+endif()
+
+# name, events, arguments
+set(_configurations
+  "emy|20000|--physics FTFP_BERT_EMY"
+  "emy_deex|20000|--physics FTFP_BERT_EMY --macro bench_deexcitation.mac"
+  "geantino|1000000|--macro bench_geantino.mac"
+  "mo|1000000|--physics livermore"
+  )
+
+foreach(_configuration ${_configurations})
+  string(REPLACE "|" ";" _fields "${_configuration}")
+  list(GET _fields 0 _name)
+  list(GET _fields 1 _events)
+  list(GET _fields 2 _arguments)
+  separate_arguments(_arguments UNIX_COMMAND "${_arguments}")
+  math(EXPR _events "${_events} * ${SCALE}")
+  foreach(_threads ${THREADS})
+    message(STATUS "benchmark ${_name}: ${_events} events, ${_threads} threads")
+    set(_output bench_${_name}_t${_threads})
+    file(GLOB _old ${_output}.* ${_output}_*)
+    if(_old)
+      file(REMOVE ${_old})
+    endif()
+    execute_process(
+      COMMAND ${EXE} ${_arguments} --events ${_events} --threads ${_threads}
+              --output ${_output} --stats ${OUTPUT}
+      OUTPUT_FILE benchmark_${_name}_t${_threads}.log
+      ERROR_FILE benchmark_${_name}_t${_threads}.log
+      RESULT_VARIABLE _result)
+    if(NOT _result EQUAL 0)
+      message(WARNING "benchmark ${_name} failed with ${_threads} threads,"
+                      " see benchmark_${_name}_t${_threads}.log")
+    endif()
+  endforeach()
+endforeach()
+
+message(STATUS "benchmark results appended to ${OUTPUT}")
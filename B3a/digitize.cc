@@ -0,0 +1,180 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file digitize.cc
+/// \brief Detector response scan on the list-mode output
+
+#include "B3Digitizer.hh"
+#include "B3Npy.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  void PrintUsage() {
+    G4cerr << " Usage: " << G4endl;
+    G4cerr << " digitize [options] output.npy input1_lm.bin input2_lm.bin ..."
+           << G4endl;
+    G4cerr << "   response (a comma-separated list scans the values,"
+           << " all the combinations):" << G4endl;
+    G4cerr << "   --fano f          Fano factor (0.1)" << G4endl;
+    G4cerr << "   --noise keV       rms electronic noise (0.25)" << G4endl;
+    G4cerr << "   --threshold keV   threshold (3)" << G4endl;
+    G4cerr << "   --cloud um        rms width of the charge cloud (0: no"
+           << " sharing)" << G4endl;
+    G4cerr << "   --escapeCd p      Cd K-alpha escape probability (0)"
+           << G4endl;
+    G4cerr << "   --escapeTe p      Te K-alpha escape probability (0)"
+           << G4endl;
+    G4cerr << "   detector and output:" << G4endl;
+    G4cerr << "   --crystals n --rings n --pitch mm   (45, 35, 3.5)"
+           << G4endl;
+    G4cerr << "   --bins n --emax keV                 (960, 24)" << G4endl;
+    G4cerr << "   --seed n                            (12345)" << G4endl;
+    G4cerr << "   writes the spectra, <u4 [combinations, bins], and"
+           << " output_params.npy," << G4endl;
+    G4cerr << "   <f8 [combinations, 6] in the order of the options above"
+           << G4endl;
+  }
+
+  G4bool ParseList(const G4String& text, std::vector<G4double>& values) {
+    G4String list = text;
+    for (size_t i = 0; i < list.size(); ++i) if (list[i] == ',') list[i] = ' ';
+    std::istringstream is(list);
+    values.clear();
+    G4double value;
+    while (is >> value) values.push_back(value);
+    return !values.empty() && is.eof();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc,char** argv)
+{
+  // scanned parameters, in the order of B3Digitizer::Parameters
+  const char* names[6]
+    = { "--fano", "--noise", "--threshold", "--cloud", "--escapeCd",
+        "--escapeTe" };
+  std::vector<G4double> values[6]
+    = { {0.1}, {0.25}, {3.}, {0.}, {0.}, {0.} };
+  G4int nbCrystals = 45;
+  G4int nbRings = 35;
+  G4double pitch = 3.5;
+  G4int nbBins = 960;
+  G4double emax = 24.;
+  G4long seed = 12345;
+
+  G4int i = 1;
+  for ( ; i < argc - 1 && G4String(argv[i]).substr(0, 2) == "--"; i += 2 ) {
+    G4String option = argv[i];
+    G4String value = argv[i+1];
+    G4int k = 0;
+    while ( k < 6 && option != names[k] ) ++k;
+    G4bool ok = true;
+    if      ( k < 6 ) ok = ParseList(value, values[k]);
+    else if ( option == "--crystals" ) nbCrystals = std::atoi(value.c_str());
+    else if ( option == "--rings" )    nbRings = std::atoi(value.c_str());
+    else if ( option == "--pitch" )    pitch = std::atof(value.c_str());
+    else if ( option == "--bins" )     nbBins = std::atoi(value.c_str());
+    else if ( option == "--emax" )     emax = std::atof(value.c_str());
+    else if ( option == "--seed" )     seed = std::atol(value.c_str());
+    else ok = false;
+    if ( ! ok ) {
+      G4cerr << "digitize: bad option " << option << " " << value << G4endl;
+      PrintUsage();
+      return 1;
+    }
+  }
+  if ( argc - i < 2 || nbCrystals <= 0 || nbRings <= 0 || pitch <= 0. ||
+       nbBins <= 0 || emax <= 0. ) {
+    PrintUsage();
+    return 1;
+  }
+  G4String output = argv[i];
+
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point start = Clock::now();
+  B3Digitizer digitizer(nbCrystals, nbRings, pitch);
+  for (G4int k = i + 1; k < argc; ++k) {
+    if ( ! digitizer.Read(argv[k]) ) return 1;
+  }
+  digitizer.Prepare(seed);
+  Clock::time_point prepared = Clock::now();
+
+  // all the combinations, the last parameter varying fastest
+  size_t nbScans = 1;
+  for (G4int k = 0; k < 6; ++k) nbScans *= values[k].size();
+  std::vector<unsigned int> spectra(nbScans*nbBins, 0);
+  std::vector<G4double> table(nbScans*6);
+  G4cout << std::setw(6) << "scan";
+  for (G4int k = 0; k < 6; ++k) G4cout << std::setw(11) << names[k] + 2;
+  G4cout << std::setw(12) << "triggers" << G4endl;
+  for (size_t scan = 0; scan < nbScans; ++scan) {
+    G4double* row = &table[6*scan];
+    size_t index = scan;
+    for (G4int k = 5; k >= 0; --k) {
+      row[k] = values[k][index % values[k].size()];
+      index /= values[k].size();
+    }
+    B3Digitizer::Parameters parameters
+      = { row[0], row[1], row[2], row[3]*1.e-3, row[4], row[5] };
+    std::vector<unsigned int> spectrum(nbBins, 0);
+    G4long nbTriggers = digitizer.Digitize(parameters, emax, spectrum);
+    std::copy(spectrum.begin(), spectrum.end(), &spectra[scan*nbBins]);
+
+    G4cout << std::setw(6) << scan;
+    for (G4int k = 0; k < 6; ++k) G4cout << std::setw(11) << row[k];
+    G4cout << std::setw(12) << nbTriggers << G4endl;
+  }
+  Clock::time_point end = Clock::now();
+
+  std::vector<size_t> shape(2);
+  shape[0] = nbScans;
+  shape[1] = nbBins;
+  G4String params = output;
+  if ( params.size() > 4 && params.substr(params.size() - 4) == ".npy" ) {
+    params.erase(params.size() - 4);
+  }
+  params += "_params.npy";
+  if ( ! B3Npy::Write(output, shape, &spectra[0]) ) return 1;
+  shape[1] = 6;
+  if ( ! B3Npy::Write(params, shape, &table[0]) ) return 1;
+
+  std::chrono::duration<G4double> read = prepared - start;
+  std::chrono::duration<G4double> scans = end - prepared;
+  G4cout << "digitize: " << digitizer.GetNbDeposits() << " deposits of "
+         << digitizer.GetNbEvents() << " events read in " << read.count()
+         << " s, " << nbScans << " responses in " << scans.count() << " s"
+         << G4endl;
+  return 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -29,38 +29,232 @@
 
 #include "G4Types.hh"
 
-#ifdef G4MULTITHREADED
-#include "G4MTRunManager.hh"
-#else
 #include "G4RunManager.hh"
+#include "G4Version.hh"
+#include "B3RunManager.hh"
+#if defined(G4MULTITHREADED) && G4VERSION_NUMBER >= 1070
+#include "G4TaskRunManager.hh"
 #endif
 
 #include "G4UImanager.hh"
+#include "G4UIcommand.hh"
+#include "G4StateManager.hh"
 #include "G4VisExecutive.hh"
 #include "G4UIExecutive.hh"
 #include "G4TScoreNtupleWriter.hh"
+#include "G4Timer.hh"
 
 #include "Randomize.hh"
 
 #include "B3DetectorConstruction.hh"
+#include "B3PhysicsList.hh"
+#include "B3PhysicsTableCache.hh"
 
 #include "G4PhysListFactory.hh"
 #include "G4VModularPhysicsList.hh"
-#include "G4LossTableManager.hh"
-#include "G4UAtomicDeexcitation.hh"
 
 #include "B3aActionInitialization.hh"
 #include "B3Analysis.hh"
+#include "B3Jobs.hh"
+
+#include <fstream>
+
+#include <dirent.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  void PrintUsage() {
+    G4cerr << " Usage: " << G4endl;
+    G4cerr << " exampleB3a [--macro file] [--events N] [--threads N]"
+           << " [--seed N] [--output name] [--physics name] [--jobs N]"
+           << " [--runManager type] [--stats file] [--ui]" << G4endl;
+    G4cerr << "   --macro   : macro executed before the run"
+           << " (a bare file name is accepted as well)" << G4endl;
+    G4cerr << "   --events  : number of events, default 1000000 without macro"
+           << G4endl;
+    G4cerr << "   --threads : number of worker threads"
+           << " (multi-threaded mode only)" << G4endl;
+    G4cerr << "   --seed    : seed of the master random engine, default 1"
+           << G4endl;
+    G4cerr << "   --output  : base name of the analysis output, default Test"
+           << G4endl;
+    G4cerr << "   --physics : a reference list, default FTFP_BERT_EMY,"
+           << " or the EM-only livermore, penelope, option4" << G4endl;
+    G4cerr << "   --jobs    : number of local processes sharing the events,"
+           << " merged into the outputs of --output" << G4endl;
+    G4cerr << "   --runManager : mt (default), tasking (Geant4 10.7 or later)"
+           << " or serial" << G4endl;
+    G4cerr << "   --stats   : appends the timings, memory and output size"
+           << " of the run to file, as a JSON line" << G4endl;
+    G4cerr << "   --ui      : interactive session with visualization" << G4endl;
+  }
+
+  // Peak resident memory of the process in MB
+  G4double PeakMemory() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss/(1024.*1024.);
+#else
+    return usage.ru_maxrss/1024.;
+#endif
+  }
+
+  // Total size in bytes of the files named <outputName>.* and
+  // <outputName>_*
+  G4double OutputSize(const G4String& outputName) {
+    G4String directory = ".";
+    G4String base = outputName;
+    size_t slash = outputName.rfind('/');
+    if ( slash != std::string::npos ) {
+      directory = outputName.substr(0, slash + 1);
+      base = outputName.substr(slash + 1);
+    }
+    G4double size = 0.;
+    DIR* dir = opendir(directory.c_str());
+    if ( ! dir ) return size;
+    while ( dirent* entry = readdir(dir) ) {
+      std::string name = entry->d_name;
+      // the separator keeps bench_t1 from counting the files of bench_t16
+      G4bool match = name.compare(0, base.size(), base) == 0 &&
+                     name.size() > base.size() &&
+                     ( name[base.size()] == '.' || name[base.size()] == '_' );
+      struct stat st;
+      if ( match && stat((directory + "/" + name).c_str(), &st) == 0 ) {
+        size += st.st_size;
+      }
+    }
+    closedir(dir);
+    return size;
+  }
+
+  // Measures of a batch run, for the benchmarks
+  struct RunStats {
+    G4String macro;
+    G4String physics;
+    G4String runManager;
+    G4int    threads;
+    G4int    events;
+    G4double setupTime;
+    G4double kernelTime;
+    G4double tablesTime;
+    G4double loopTime;
+    G4double initMemory;
+    G4double peakMemory;
+    G4double outputSize;
+  };
+
+  void WriteStats(const G4String& fileName, const RunStats& stats) {
+    std::ofstream output(fileName, std::ios::app);
+    G4double workerMemory = stats.threads > 0 ?
+      (stats.peakMemory - stats.initMemory)/stats.threads : 0.;
+    output << "{\"macro\": \"" << stats.macro << "\""
+           << ", \"physics\": \"" << stats.physics << "\""
+           << ", \"run_manager\": \"" << stats.runManager << "\""
+           << ", \"threads\": " << stats.threads
+           << ", \"events\": " << stats.events
+           << ", \"setup_s\": " << stats.setupTime
+           << ", \"kernel_init_s\": " << stats.kernelTime
+           << ", \"physics_tables_s\": " << stats.tablesTime
+           << ", \"event_loop_s\": " << stats.loopTime
+           << ", \"events_per_s\": "
+           << (stats.loopTime > 0. ? stats.events/stats.loopTime : 0.)
+           << ", \"peak_rss_init_mb\": " << stats.initMemory
+           << ", \"peak_rss_mb\": " << stats.peakMemory
+           << ", \"rss_per_worker_mb\": " << workerMemory
+           << ", \"output_bytes\": " << stats.outputSize << "}" << std::endl;
+    if ( ! output ) G4cerr << "Cannot write " << fileName << G4endl;
+  }
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 int main(int argc,char** argv)
 {
-  // Detect interactive mode (if no arguments) and define UI session
+  G4Timer setupTimer;
+  setupTimer.Start();
+
+  // Evaluate arguments
+  //
+  G4String macro;
+  G4String outputName = "Test";
+  G4String physicsName = "FTFP_BERT_EMY";
+  G4int nofEvents = -1;
+  G4int nofThreads = 0;
+  G4int seed = 1;
+  G4int nofJobs = 1;
+  G4String runManagerType = "mt";
+  G4String statsFile;
+  G4bool interactive = false;
+  for ( G4int i=1; i<argc; ++i ) {
+    G4String arg = argv[i];
+    if ( arg == "--ui" ) {
+      interactive = true;
+      continue;
+    }
+    if ( arg == "--help" ) {
+      PrintUsage();
+      return 0;
+    }
+    if ( arg.substr(0,2) != "--" ) {
+      macro = arg;
+      continue;
+    }
+    if ( i+1 >= argc ) {
+      PrintUsage();
+      return 1;
+    }
+    G4String value = argv[++i];
+    if      ( arg == "--macro" )   macro = value;
+    else if ( arg == "--events" )  nofEvents = G4UIcommand::ConvertToInt(value);
+    else if ( arg == "--threads" ) nofThreads = G4UIcommand::ConvertToInt(value);
+    else if ( arg == "--seed" )    seed = G4UIcommand::ConvertToInt(value);
+    else if ( arg == "--output" )  outputName = value;
+    else if ( arg == "--physics" ) physicsName = value;
+    else if ( arg == "--jobs" )    nofJobs = G4UIcommand::ConvertToInt(value);
+    else if ( arg == "--stats" )   statsFile = value;
+    else if ( arg == "--runManager" && ( value == "mt" || value == "tasking" ||
+                                         value == "serial" ) ) {
+      runManagerType = value;
+    }
+    else {
+      PrintUsage();
+      return 1;
+    }
+  }
+
+  // Split the events over local processes, before any Geant4 object
+  // exists; the parent only waits for the jobs and merges their outputs
+  //
+  if ( nofJobs > 1 ) {
+    if ( interactive || ( macro.size() && nofEvents < 0 ) ) {
+      G4cerr << "--jobs needs a batch run of --events events" << G4endl;
+      PrintUsage();
+      return 1;
+    }
+    if ( nofEvents < 0 ) nofEvents = 1000000;
+    B3Jobs jobs(nofJobs, outputName, nofEvents);
+    G4int job = jobs.Fork();
+    if ( job < 0 ) return jobs.IsSuccessful() ? 0 : 1;
+    outputName = jobs.GetOutputName(job);
+    nofEvents = jobs.GetNofEvents(job);
+    // disjoint seeds for all the --seed values of the same number of jobs
+    seed = seed*nofJobs + job;
+    if ( nofThreads == 0 ) nofThreads = jobs.GetNofCpus();
+  }
+
+  // Define UI session and visualization for interactive mode only;
+  // nothing of the vis system is built in batch mode
   //
   G4UIExecutive* ui = 0;
-  if ( argc == 1 ) {
+  G4VisManager* visManager = 0;
+  if ( interactive ) {
     ui = new G4UIExecutive(argc, argv);
+    visManager = new G4VisExecutive;
+    visManager->Initialize();
   }
 
   // Optionally: choose a different Random engine...
@@ -69,85 +263,173 @@ int main(int argc,char** argv)
 
   // Construct the default run manager
   //
+  // The MT run manager sizes the event chunks by their measured cost
+  // (B3RunManager.hh); the tasking one keeps its static chunks
+  //
+  G4RunManager* runManager = 0;
 #ifdef G4MULTITHREADED
-  G4MTRunManager* runManager = new G4MTRunManager;
+  if ( runManagerType == "tasking" ) {
+#if G4VERSION_NUMBER >= 1070
+    runManager = new G4TaskRunManager;
 #else
-  G4RunManager* runManager = new G4RunManager;
+    G4cerr << "The tasking run manager needs Geant4 10.7 or later,"
+           << " using the MT one." << G4endl;
+#endif
+  }
+  if ( ! runManager && runManagerType != "serial" ) {
+    runManager = new B3MTRunManager;
+  }
 #endif
+  if ( ! runManager ) {
+    runManager = new G4RunManager;
+  }
+  if ( nofThreads > 0 ) {
+    runManager->SetNumberOfThreads(nofThreads);
+  }
 
   // Set mandatory initialization classes
   //
   runManager->SetUserInitialization(new B3DetectorConstruction);
   //
+  // The reference FTFP_BERT_EMY stays the default. The EM-only
+  // B3PhysicsList is used for its livermore, penelope and option4
+  // variants, which skip the hadronic tables; the startup times and peak
+  // memory of both are in the --stats line (emy and mo of benchmark.cmake).
+  // Any other name is taken from G4PhysListFactory
+  G4VModularPhysicsList* physicsList = 0;
+  if ( B3PhysicsList::IsEmPhysicsName(physicsName) ) {
+    physicsList = new B3PhysicsList(physicsName);
+    runManager->SetUserInitialization(physicsList);
+  }
+  else {
     // Basti
-  G4PhysListFactory physListFactory;
-  G4VModularPhysicsList* physicsList = physListFactory.GetReferencePhysList("FTFP_BERT_EMY");
-  physicsList->SetCutValue(0.001*CLHEP::mm, "gamma");
-  runManager->SetUserInitialization(physicsList);
-
-
-  G4VAtomDeexcitation* de = new G4UAtomicDeexcitation();
-  de->SetFluo(true);
-  de->SetAuger(true);
-  de->SetPIXE(true);
-  de->InitialiseAtomicDeexcitation();
-  G4LossTableManager::Instance()->SetAtomDeexcitation(de);
-
-  // Set user action initialization
+    G4PhysListFactory physListFactory;
+    if ( ! physListFactory.IsReferencePhysList(physicsName) ) {
+      G4cerr << "Unknown physics list " << physicsName << G4endl;
+      PrintUsage();
+      delete visManager;
+      delete runManager;
+      return 1;
+    }
+    physicsList = physListFactory.GetReferencePhysList(physicsName);
+    runManager->SetUserInitialization(physicsList);
+    // the atomic de-excitation of the list, activated per region below
+  }
+  // the fast simulation of the photons is added with a response library
+  // of the ring (/B3/det/responseLibrary, B3DetectorConstruction)
+  G4cout << "### Physics list: " << physicsName << G4endl;
   //
-  runManager->SetUserInitialization(new B3aActionInitialization());
+  // Physics tables of the master stored once per physics, cuts and
+  // materials, and retrieved by the next jobs (/B3/tables/cacheDirectory)
+  B3PhysicsTableCache* tableCache = new B3PhysicsTableCache(physicsList);
 
-  // Initialize visualization
+  // Set user action initialization
   //
-  G4VisManager* visManager = new G4VisExecutive;
-
-  visManager->Initialize();
+  runManager->SetUserInitialization(new B3aActionInitialization(outputName));
 
   // Get the pointer to the User Interface manager
   G4UImanager* UImanager = G4UImanager::GetUIpointer();
-  UImanager->ApplyCommand("/process/em/fluo true");
-  UImanager->ApplyCommand("/process/em/auger true");
-  UImanager->ApplyCommand("/process/em/augerCascade true");
-  UImanager->ApplyCommand("/process/em/pixe true");
-  UImanager->ApplyCommand("/run/setCutForAGivenParticle gamma 0.0001 mm");
+  // Atomic de-excitation only in the regions where the fluorescence is
+  // produced and detected; no global /process/em/fluo, auger or pixe, so
+  // nothing is simulated in the patient tissue nor in the air.
+  // Macros can override these with the same command and set the region
+  // cuts with /run/setCutForRegion (see regions.mac).
+  UImanager->ApplyCommand("/process/em/deexcitation MoSolution true true true");
+  UImanager->ApplyCommand("/process/em/deexcitation Detector true true true");
   //UImanager->ApplyCommand("/random/resetEngineFrom currentRun.rndm");
-  UImanager->ApplyCommand("/random/setSeed 1");
+  UImanager->ApplyCommand("/random/setSeed " + G4UIcommand::ConvertToString(seed));
+  UImanager->ApplyCommand("/B3/reproducible/seed " + G4UIcommand::ConvertToString(seed));
 
   // Activate score ntuple writer
-  // The Root output type (Root) is selected in B3Analysis.hh.
+  // The output type is selected in B3Analysis.hh (B3_ANALYSIS in CMake).
   // The verbose level can be also set via UI commands
   // /score/ntuple/writerVerbose level
   G4TScoreNtupleWriter<G4AnalysisManager> scoreNtupleWriter;
   scoreNtupleWriter.SetVerboseLevel(1);
 
-  // Initialize G4 kernel
-  runManager->Initialize();
-
-  // start a run
-  int numberOfEvent = 1e+06;
-  runManager->BeamOn(numberOfEvent);
-
-//  // Process macro or start UI session
-//  //
-//  if ( ! ui ) {
-//    // batch mode
-//    G4String command = "/control/execute ";
-//    G4String fileName = argv[1];
-//    UImanager->ApplyCommand(command+fileName);
-//  }
-//  else {
-//    // interactive mode
-//    UImanager->ApplyCommand("/control/execute init_vis.mac");
-//    ui->SessionStart();
-//    delete ui;
-//  }
+  setupTimer.Stop();
+  RunStats stats = { macro, physicsName, runManagerType, 0, 0,
+                     setupTimer.GetRealElapsed(), 0., 0., 0., 0., 0., 0. };
+  G4cout << "### Setup time: " << setupTimer.GetRealElapsed() << " s"
+         << ", peak memory: " << PeakMemory() << " MB" << G4endl;
 
+  // Process macro or start UI session
+  //
+  if ( ui ) {
+    // interactive mode
+    if ( macro.size() ) {
+      UImanager->ApplyCommand("/control/execute " + macro);
+    }
+    else {
+      UImanager->ApplyCommand("/control/execute init_vis.mac");
+    }
+    ui->SessionStart();
+    delete ui;
+  }
+  else {
+    // batch mode
+    if ( macro.size() ) {
+      G4Timer macroTimer;
+      macroTimer.Start();
+      UImanager->ApplyCommand("/control/execute " + macro);
+      macroTimer.Stop();
+      G4cout << "### Macro " << macro << " time: "
+             << macroTimer.GetRealElapsed() << " s" << G4endl;
+    }
+    else if ( nofEvents < 0 ) {
+      nofEvents = 1000000;
+    }
+
+    if ( nofEvents > 0 ) {
+      // Initialize G4 kernel, unless the macro did it already.
+      // The physics tables are built by an empty run, so that
+      // their cost is reported apart from the event loop.
+      if ( G4StateManager::GetStateManager()->GetCurrentState()
+           == G4State_PreInit ) {
+        G4Timer initTimer;
+        initTimer.Start();
+        runManager->Initialize();
+        initTimer.Stop();
+        G4double kernelTime = initTimer.GetRealElapsed();
+        initTimer.Start();
+        runManager->BeamOn(0);
+        initTimer.Stop();
+        G4double tablesTime = initTimer.GetRealElapsed();
+        G4cout << "### Initialization time: " << kernelTime + tablesTime
+               << " s (kernel " << kernelTime << " s, physics tables "
+               << tablesTime << " s), peak memory: " << PeakMemory()
+               << " MB" << G4endl;
+        stats.kernelTime = kernelTime;
+        stats.tablesTime = tablesTime;
+      }
+      stats.initMemory = PeakMemory();
+
+      // start a run
+      G4Timer runTimer;
+      runTimer.Start();
+      runManager->BeamOn(nofEvents);
+      runTimer.Stop();
+      G4cout << "### Event loop time: " << runTimer.GetRealElapsed() << " s ("
+             << nofEvents/runTimer.GetRealElapsed() << " events/s)"
+             << ", peak memory: " << PeakMemory() << " MB" << G4endl;
+
+      if ( statsFile.size() ) {
+        stats.threads = runManager->GetNumberOfThreads();
+        stats.events = nofEvents;
+        stats.loopTime = runTimer.GetRealElapsed();
+        stats.peakMemory = PeakMemory();
+        stats.outputSize = OutputSize(outputName);
+        WriteStats(statsFile, stats);
+      }
+    }
+  }
 
   // Job termination
   // Free the store: user actions, physics_list and detector_description are
   // owned and deleted by the run manager, so they should not be deleted
   // in the main() program !
 
+  delete tableCache;
   delete visManager;
   delete runManager;
 }
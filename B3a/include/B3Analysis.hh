@@ -26,12 +26,20 @@
 //
 /// \file B3Analysis.hh
 /// \brief Selection of the analysis technology
+///
+/// The single place where the output type is chosen, for main() and the
+/// user actions alike: Root by default, csv or xml with the B3_ANALYSIS
+/// CMake option (B3_ANALYSIS_CSV or B3_ANALYSIS_XML defined).
 
 #ifndef B3Analysis_h
 #define B3Analysis_h 1
 
+#if defined(B3_ANALYSIS_CSV)
+#include "g4csv.hh"
+#elif defined(B3_ANALYSIS_XML)
+#include "g4xml.hh"
+#else
 #include "g4root.hh"
-//#include "g4csv.hh"
-//#include "g4xml.hh"
+#endif
 
 #endif
@@ -0,0 +1,130 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3AutoStop.hh
+/// \brief Definition of the B3AutoStop class
+
+#ifndef B3AutoStop_h
+#define B3AutoStop_h 1
+
+#include "globals.hh"
+
+#include <atomic>
+#include <chrono>
+
+class B3AutoStopMessenger;
+
+/// Stop of a run on its statistical uncertainty or on a time limit.
+///
+/// Each thread sums, history by history, the number of good pixels, the
+/// dose in the patient and the number of pixel deposits in an energy
+/// window, and their squares. Every checkInterval events it adds these
+/// sums to shared atomics, with no lock, and computes from them the
+/// relative standard error of the mean of the selected observables. When
+/// all of them are below the target precision, or when the time limit of
+/// the run is reached, it raises a shared flag; each thread reads the flag
+/// at the end of its events and aborts its own event loop after the
+/// current event, so the run ends cleanly with all the completed events.
+/// Events restored from a checkpoint are not counted. The number of
+/// events of a stopped run depends on the timing of the threads.
+/// The observables, the precision, the energy window and the time limit
+/// are set with the /B3/autoStop/ commands.
+
+class B3AutoStop
+{
+  public:
+    enum Observable { kGoodEvents, kDose, kWindow, kNofObservables };
+
+    B3AutoStop();
+    ~B3AutoStop();
+
+    void SetEnabled(G4bool flag)          { fEnabled = flag; }
+    void SetPrecision(G4double precision) { fPrecision = precision; }
+    void SetTimeLimit(G4double limit)     { fTimeLimit = limit; }
+    void SetWindow(G4double emin, G4double emax);
+    void SetObservables(const G4String& names);
+    void SetCheckInterval(G4int nbEvents) { fCheckInterval = nbEvents; }
+    G4bool IsEnabled() const              { return fEnabled; }
+
+    void BeginOfRun(G4bool master);
+    inline void ScorePixel(G4double edep);
+    inline void ScoreDose(G4double dose);
+    void EndOfEvent(G4int eventID);
+    void EndOfRun(G4bool tracking);
+    // on the master, after the threads
+    void Report() const;
+
+  private:
+    enum Reason { kNone, kPrecision, kTimeLimit };
+    typedef std::chrono::steady_clock Clock;
+
+    void   Publish();
+    G4int  Check() const;
+    static G4double RelativeError(G4int observable);
+
+    G4bool   fEnabled;
+    G4double fPrecision;
+    G4double fTimeLimit;
+    G4double fWindowMin;
+    G4double fWindowMax;
+    G4bool   fSelected[kNofObservables];
+    G4int    fCheckInterval;
+
+    // current history and the histories not yet published
+    G4double fHistory[kNofObservables];
+    G4double fSum[kNofObservables];
+    G4double fSum2[kNofObservables];
+    G4long   fNofEvents;
+
+    // shared by the threads; reset by the master before the workers start
+    static std::atomic<G4double> fgSum[kNofObservables];
+    static std::atomic<G4double> fgSum2[kNofObservables];
+    static std::atomic<G4long>   fgNofEvents;
+    static std::atomic<G4int>    fgReason;
+    static Clock::time_point     fgRunStart;
+
+    B3AutoStopMessenger* fMessenger;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B3AutoStop::ScorePixel(G4double edep)
+{
+  if (!fEnabled) return;
+  fHistory[kGoodEvents] += 1.;
+  if (edep >= fWindowMin && edep < fWindowMax) fHistory[kWindow] += 1.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B3AutoStop::ScoreDose(G4double dose)
+{
+  if (fEnabled) fHistory[kDose] += dose;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
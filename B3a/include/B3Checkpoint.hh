@@ -0,0 +1,120 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3Checkpoint.hh
+/// \brief Definition of the B3Checkpoint class
+
+#ifndef B3Checkpoint_h
+#define B3Checkpoint_h 1
+
+#include "globals.hh"
+
+#include <chrono>
+#include <vector>
+
+class B3CheckpointMessenger;
+
+/// Periodic checkpoints of a run, and resume from them.
+///
+/// Every tracking thread writes, at most every interval and always at an
+/// event boundary, a binary file holding the IDs of the events it has
+/// completed in the run, all the registered accumulables (G4int and
+/// G4double G4Accumulable, B3HistoryTally, B3CountTally) and the bins of
+/// all the H1 and H2 histograms. The file is written aside and renamed,
+/// so a preemption never leaves a partial checkpoint.
+///
+/// When the same run is started again (same output name, seed and number
+/// of events), the master adds all the checkpoint files of the run to its
+/// accumulables and histograms, and the primary generator leaves the
+/// restored events empty. In multi-threaded mode the seeds of each event
+/// come from the master whatever the thread that processes it, so the
+/// remaining events are simulated as in an uninterrupted run, but the sums
+/// are added in another order: the results are the same up to the
+/// floating-point rounding. In sequential mode, where one thread runs all
+/// the events, the engine state is saved with the checkpoint and restored
+/// and the results are bitwise identical. A run with the list mode on is
+/// not resumed, its files holding only the events of the last start. The
+/// seed and the number of events are in the header of the files: a start
+/// with others stops with an exception, as the restored sums would be
+/// normalised to the wrong number of events. The checkpoint files are
+/// removed at the end of a complete run.
+///
+/// Files: <output>_ckpt_g<generation>_t<thread>.bin, one generation per
+/// restart.
+
+class B3Checkpoint
+{
+  public:
+    B3Checkpoint();
+    ~B3Checkpoint();
+
+    void SetEnabled(G4bool flag)       { fEnabled = flag; }
+    void SetInterval(G4double interval) { fInterval = interval; }
+    G4bool IsEnabled() const           { return fEnabled; }
+
+    // the master restores the checkpoints of the run,
+    // the tracking threads start the next generation of files
+    void BeginOfRun(const G4String& runName, G4int nofEvents, G4bool master,
+                    G4bool tracking, G4bool listMode);
+    void EndOfEvent(G4int eventID);
+    void EndOfRun(G4bool master);
+
+    // event restored from a checkpoint, to be skipped
+    static G4bool IsDone(G4int eventID)
+      { return size_t(eventID) < fgDone.size() && fgDone[eventID]; }
+
+  private:
+    struct File {
+      G4int    generation;
+      G4String name;
+      bool operator<(const File& other) const
+        { return generation < other.generation; }
+    };
+
+    std::vector<File> FindFiles() const;
+    void   Write();
+    G4bool Restore(const G4String& fileName, G4bool sequential);
+
+    G4bool   fEnabled;
+    G4double fInterval;
+    G4String fRunName;
+    G4String fFileName;
+    std::vector<G4int> fEvents;
+    std::vector<G4String> fSuperseded;
+    std::chrono::steady_clock::time_point fLastWrite;
+
+    // shared by the threads, set by the master before the workers start
+    static std::vector<char> fgDone;
+    static G4int fgGeneration;
+    static G4int fgNofEvents;
+    static G4long fgSeed;
+
+    B3CheckpointMessenger* fMessenger;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,71 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3CountTally.hh
+/// \brief Definition of the B3CountTally class
+
+#ifndef B3CountTally_h
+#define B3CountTally_h 1
+
+#include "G4VAccumulable.hh"
+#include "globals.hh"
+
+#include <iosfwd>
+#include <vector>
+
+/// Accumulable array of 32-bit counts.
+///
+/// The counts of a thread live in one flat array, allocated once by
+/// SetSize(); Merge() is a plain element-wise sum. The master copy takes
+/// its size from the first merged worker. Save() and Restore() write and
+/// add back the counts for checkpoints.
+
+class B3CountTally : public G4VAccumulable
+{
+  public:
+    B3CountTally(const G4String& name);
+    virtual ~B3CountTally();
+
+    void   SetSize(size_t size);
+    size_t GetSize() const { return fCounts.size(); }
+
+    void Count(size_t index) { ++fCounts[index]; }
+
+    virtual void Merge(const G4VAccumulable& other);
+    virtual void Reset();
+
+    void   Save(std::ostream& output) const;
+    G4bool Restore(std::istream& input);
+
+    const std::vector<unsigned int>& GetCounts() const { return fCounts; }
+
+  private:
+    std::vector<unsigned int> fCounts;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,76 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3CrystalParameterisation.hh
+/// \brief Definition of the B3CrystalParameterisation class
+
+#ifndef B3CrystalParameterisation_h
+#define B3CrystalParameterisation_h 1
+
+#include "G4VPVParameterisation.hh"
+#include "G4RotationMatrix.hh"
+#include "G4ThreeVector.hh"
+
+#include <vector>
+
+class B3DetectorConstruction;
+class G4Material;
+
+/// Parameterisation of the crystals of a ring, copy number = crystal.
+///
+/// Crystal i is rotated by i*dPhi around z, with its inner face at the
+/// inner radius of the ring. The rings are replicas along z, so a single
+/// placement describes all the crystals; the crystal of the beam hole is
+/// given the material of the ring, from the replica number of its ring
+/// in the parent touchable, and is a dead pixel of B3PixelSD.
+
+class B3CrystalParameterisation : public G4VPVParameterisation
+{
+  public:
+    B3CrystalParameterisation(const B3DetectorConstruction* detector,
+                              G4Material* crystalMaterial,
+                              G4Material* holeMaterial);
+    virtual ~B3CrystalParameterisation();
+
+    virtual void ComputeTransformation(const G4int copyNo,
+                                       G4VPhysicalVolume* physVol) const;
+    virtual G4Material* ComputeMaterial(const G4int copyNo,
+                                        G4VPhysicalVolume* currentVol,
+                                        const G4VTouchable* parentTouch = 0);
+
+  private:
+    const B3DetectorConstruction* fDetector;
+    G4Material* fCrystalMaterial;
+    G4Material* fHoleMaterial;
+
+    // frame rotations and positions, one per crystal
+    std::vector<G4RotationMatrix> fRotations;
+    std::vector<G4ThreeVector>    fPositions;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -31,15 +31,56 @@
 #define B3DetectorConstruction_h 1
 
 #include "G4VUserDetectorConstruction.hh"
+#include "G4ThreeVector.hh"
 #include "globals.hh"
 
 class G4VPhysicalVolume;
 class G4LogicalVolume;
+class G4Material;
+class B3VoxelPhantom;
+class B3CrystalParameterisation;
+class B3OverlapCheck;
+class B3ResponseModel;
+class B3DetectorMessenger;
+class G4FastSimulationPhysics;
 
 /// Detector construction class to define materials and geometry.
 ///
-/// Crystals are positioned in Ring, with an appropriate rotation matrix. 
-/// Several copies of Ring are placed in the full detector.
+/// Crystals are positioned in Ring by B3CrystalParameterisation, with an
+/// appropriate rotation matrix; Ring is replicated along z in the full
+/// detector. The crystal of the beam hole is left in air by the
+/// parameterisation, so two levels of one volume each describe all the
+/// pixels, whatever their number.
+///
+/// The Mo solution, the patient and the detector are the root volumes of
+/// the regions "MoSolution", "Patient" and "Detector", each with its own
+/// production cuts; the world keeps the default cuts. The cuts can be
+/// changed with /run/setCutForRegion.
+///
+/// The default patient is a tissue cylinder holding a cube of Mo solution.
+/// When an index file is given with /B3/det/phantom/indexFile, it is
+/// replaced by the voxel phantom of B3VoxelPhantom: the "Patient" region
+/// and the "patient" scorer then cover the voxels, and the Mo is in the
+/// voxel materials, so there is no "MoSolution" region.
+///
+/// The overlaps are checked once the whole geometry is placed, by
+/// B3OverlapCheck, unless it was found free of overlaps in a previous run.
+///
+/// When a library is given with /B3/det/responseLibrary, the photons
+/// entering the ring are not transported in the crystals: B3ResponseModel
+/// adds the deposits of a library outcome to the pixels instead. The
+/// library must have been built for the same crystal cell. The fast
+/// simulation process is only added to the photons with a library, so
+/// the other runs do not pay for it at every step.
+///
+/// The constructed geometry can be exported to a GDML file for external
+/// tools with /B3/det/gdml/write; see B3GeometrySnapshot.
+///
+/// The crystals, the rings and the Mo mass are set with /B3/det/...
+/// commands. In the Idle state these rebuild the geometry at the next run,
+/// with G4RunManager::ReinitializeGeometry(), in the same process: the
+/// previous volumes are deleted, while the regions, their cuts, the
+/// sensitive detectors and the physics tables are kept.
 
 class B3DetectorConstruction : public G4VUserDetectorConstruction
 {
@@ -50,9 +91,82 @@ class B3DetectorConstruction : public G4VUserDetectorConstruction
   public:
     virtual G4VPhysicalVolume* Construct();
     virtual void ConstructSDandField();
+
+    G4int GetNbCrystals() const { return fNbCrystals; }
+    G4int GetNbRings()    const { return fNbRings; }
+    G4int GetNbPixels()   const { return fNbCrystals*fNbRings; }
+
+    G4double GetCrystalDX() const { return fCrystalDX; }
+    G4double GetCrystalDY() const { return fCrystalDY; }
+    G4double GetCrystalDZ() const { return fCrystalDZ; }
+    G4double GetGap()       const { return fGap; }
+    G4double GetRingInnerRadius() const;
+    const G4Material* GetCrystalMaterial() const { return fCrystalMaterial; }
+    G4double GetMoMass() const { return fMoMass; }
+
+    void SetNbCrystals(G4int value)   { fNbCrystals = value; }
+    void SetNbRings(G4int value)      { fNbRings = value; }
+    void SetCrystalSize(const G4ThreeVector& size)
+      { fCrystalDX = size.x(); fCrystalDY = size.y(); fCrystalDZ = size.z(); }
+    void SetGap(G4double value)       { fGap = value; }
+    void SetMoMass(G4double value)    { fMoMass = value; }
+    // false, and unchanged, if NIST does not know the material
+    G4bool SetCrystalMaterial(const G4String& name);
+
+    // the crystal 0 of the central ring is left out for the beam
+    G4bool IsBeamHole(G4int ring, G4int crystal) const
+      { return ring == fNbRings/2 && crystal == 0; }
+
+    // pixel = ring*nbCrystals + crystal, as in B3PixelSD;
+    // outward radial direction and centre of the crystal inner face
+    G4ThreeVector GetPixelDirection(G4int pixel) const;
+    G4ThreeVector GetPixelEntrance(G4int pixel) const;
+
+    B3VoxelPhantom* GetVoxelPhantom() const { return fVoxelPhantom; }
+    B3OverlapCheck* GetOverlapCheck() const { return fOverlapCheck; }
+
+    void SetResponseLibrary(const G4String& name);
+    const G4String& GetResponseLibrary() const   { return fResponseLibrary; }
+
+    // GDML snapshot written once the geometry is constructed; empty for none
+    void SetGdmlWriteFile(const G4String& name) { fGdmlWriteFile = name; }
+
+    // medium with Mo dissolved at the given concentration (mass per
+    // volume of solution); the medium itself if the concentration is 0
+    static G4Material* BuildMoSolution(const G4String& name,
+                                       G4Material* medium,
+                                       G4double concentration);
                
   private:
-    G4bool  fCheckOverlaps;
+    void ClearGeometry();
+    G4VPhysicalVolume* ConstructVolumes();
+    void PlaceCrystals(G4LogicalVolume* logicCryst, G4LogicalVolume* logicRing,
+                       G4Material* holeMaterial);
+    G4LogicalVolume* ConstructPatient(G4LogicalVolume* logicWorld);
+    void CheckPatientFits(const G4ThreeVector& halfSize, G4double ringRadius,
+                          G4double worldHalfZ) const;
+    void SetupRegion(const G4String& name, G4LogicalVolume* rootVolume,
+                     G4double gammaCut);
+
+    G4int   fNbCrystals;
+    G4int   fNbRings;
+    G4double fCrystalDX;
+    G4double fCrystalDY;
+    G4double fCrystalDZ;
+    G4double fGap;
+    G4Material* fCrystalMaterial;
+    G4String fCrystalMaterialName;
+    G4double fMoMass;
+    G4String fResponseLibrary;
+    G4FastSimulationPhysics* fFastSimulation;
+    G4String fGdmlWriteFile;
+
+    B3CrystalParameterisation* fCrystalParameterisation;
+    B3VoxelPhantom* fVoxelPhantom;
+    B3OverlapCheck* fOverlapCheck;
+    B3DetectorMessenger* fMessenger;
+
+    static G4ThreadLocal B3ResponseModel* fgResponseModel;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
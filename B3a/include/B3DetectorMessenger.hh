@@ -0,0 +1,90 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3DetectorMessenger.hh
+/// \brief Definition of the B3DetectorMessenger class
+
+#ifndef B3DetectorMessenger_h
+#define B3DetectorMessenger_h 1
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class B3DetectorConstruction;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWith3VectorAndUnit;
+class G4UIcmdWithABool;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithADoubleAndUnit;
+
+/// Messenger of B3DetectorConstruction.
+///
+/// The commands are not broadcast to the workers, the geometry being
+/// built on the master. Those of the crystals, the rings and the Mo mass
+/// are also available in the Idle state, where they ask the run manager
+/// to rebuild the geometry at the next run, and stop reading a GDML
+/// snapshot, which has its own parameters; the others are PreInit only.
+
+class B3DetectorMessenger: public G4UImessenger
+{
+  public:
+    B3DetectorMessenger(B3DetectorConstruction* detector);
+    virtual ~B3DetectorMessenger();
+
+    virtual void SetNewValue(G4UIcommand*, G4String);
+
+  private:
+    void ReinitializeGeometry() const;
+
+    B3DetectorConstruction*    fDetector;
+
+    G4UIdirectory*             fDetDir;
+    G4UIdirectory*             fPhantomDir;
+    G4UIcmdWithAnInteger*      fNbCrystalsCmd;
+    G4UIcmdWithAnInteger*      fNbRingsCmd;
+    G4UIcmdWith3VectorAndUnit* fCrystalSizeCmd;
+    G4UIcmdWithADoubleAndUnit* fGapCmd;
+    G4UIcmdWithAString*        fCrystalMaterialCmd;
+    G4UIcmdWithADoubleAndUnit* fMoMassCmd;
+    G4UIcmdWithAString*        fResponseLibraryCmd;
+    G4UIdirectory*             fOverlapsDir;
+    G4UIcmdWithABool*          fOverlapsCheckCmd;
+    G4UIcmdWithABool*          fOverlapsForceCmd;
+    G4UIcmdWithAString*        fOverlapsCacheCmd;
+    G4UIdirectory*             fGdmlDir;
+    G4UIcmdWithAString*        fGdmlWriteCmd;
+    G4UIcmdWithAString*        fIndexFileCmd;
+    G4UIcmdWithAString*        fMaterialFileCmd;
+    G4UIcmdWithAString*        fMoMapFileCmd;
+    G4UIcommand*               fNbVoxelsCmd;
+    G4UIcmdWith3VectorAndUnit* fVoxelSizeCmd;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
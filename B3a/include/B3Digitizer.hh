@@ -0,0 +1,112 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3Digitizer.hh
+/// \brief Definition of the B3Digitizer class
+
+#ifndef B3Digitizer_h
+#define B3Digitizer_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+/// Detector response applied offline to the list-mode pixel deposits.
+///
+/// Read() loads the records of B3ListMode files into flat arrays (structure
+/// of arrays, G4float in keV). Prepare() draws once all the random numbers
+/// of the response; each Digitize() call then applies one set of parameters
+/// with the same random numbers, so the spectra of a parameter scan differ
+/// only by the parameters, and builds the spectrum of the triggered pixels.
+/// In order, on each deposit:
+///  - K-alpha escape of Cd (23.17 keV) or Te (27.47 keV) with the given
+///    probabilities above their K edges, for simulations without
+///    fluorescence (a simulation with fluorescence has them already);
+///  - Fano-limited charge statistics, sigma^2 = F*w*E with w = 4.43 eV;
+///  - charge sharing with the 4 neighbour pixels of a Gaussian charge
+///    cloud, from a uniform position in the pixel (the list mode has no
+///    position in the pixel); the corners go to the crystal neighbours,
+///    the charge leaving the first or last ring is lost;
+/// then on each pixel of an event, summed: Gaussian electronic noise and
+/// the threshold. The loops over the deposits have no branch and run on
+/// contiguous arrays, so the compiler vectorizes them.
+
+class B3Digitizer
+{
+  public:
+    struct Parameters {
+      G4double fano;       // Fano factor
+      G4double noise;      // keV, rms of the electronic noise
+      G4double threshold;  // keV
+      G4double cloud;      // mm, rms width of the charge cloud; 0 for none
+      G4double escapeCd;   // probability of a Cd K-alpha escape
+      G4double escapeTe;   // probability of a Te K-alpha escape
+    };
+
+    B3Digitizer(G4int nbCrystals, G4int nbRings, G4double pitch);
+    ~B3Digitizer();
+
+    G4bool Read(const G4String& fileName);
+    void   Prepare(G4long seed);
+
+    size_t GetNbDeposits() const { return fEdep.size(); }
+    G4long GetNbEvents() const   { return fNbEvents; }
+
+    // adds the triggered pixels in [0, emax) to the spectrum,
+    // returns the number of triggered pixels
+    G4long Digitize(const Parameters& parameters, G4double emax,
+                    std::vector<unsigned int>& spectrum);
+
+  private:
+    void Share(G4double cloud);
+
+    G4int    fNbCrystals;
+    G4int    fNbRings;
+    G4double fPitch;
+    G4long   fNbEvents;
+
+    // deposits
+    std::vector<G4int>   fEvent;
+    std::vector<G4int>   fPixel;
+    std::vector<G4float> fEdep;
+
+    // random numbers, drawn once
+    std::vector<G4float> fFanoGauss;
+    std::vector<G4float> fEscapeFlat;
+    std::vector<G4float> fPositionU;   // along the crystals of a ring
+    std::vector<G4float> fPositionV;   // along the rings
+    std::vector<G4float> fNoiseGauss;
+
+    // work arrays: charge of the deposits, then of the pixels
+    std::vector<G4float> fCharge;
+    std::vector<G4float> fShare[4];
+    std::vector<G4int>   fSignalPixel;
+    std::vector<G4float> fSignal;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
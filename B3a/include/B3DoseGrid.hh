@@ -0,0 +1,107 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3DoseGrid.hh
+/// \brief Definition of the B3DoseGrid class
+
+#ifndef B3DoseGrid_h
+#define B3DoseGrid_h 1
+
+#include "B3HistoryTally.hh"
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+class B3DoseGridMessenger;
+class G4Navigator;
+class G4Region;
+class G4Step;
+
+/// 3D dose grid over the bounding box of the patient.
+///
+/// The energy deposit of each step in the Patient and MoSolution regions is
+/// put at the midpoint of the step, so that scoring draws no random number
+/// and does not change the histories. The energies are summed in a flat
+/// B3HistoryTally, energy and energy squared per event, and merged on the
+/// master at end of run with the other accumulables.
+///
+/// The mass of a cell is computed from the geometry when the grid is
+/// written, for the cells with a deposit only: the cell is sampled on a
+/// regular lattice of points located in the world, and the points in the
+/// scored regions contribute the density of their material. A cell across
+/// the Mo solution and the tissue, or across voxels of a phantom, thus
+/// gets the mass of its actual content.
+///
+/// The result is written as a .npy array of shape (2, nz, ny, nx): mean
+/// dose per primary and its standard error, in Gy. Enabled with
+/// /B3/dose/enable.
+
+class B3DoseGrid
+{
+  public:
+    B3DoseGrid();
+    ~B3DoseGrid();
+
+    void SetEnabled(G4bool flag) { fEnabled = flag; }
+    void SetNbBins(G4int nx, G4int ny, G4int nz);
+    G4bool IsEnabled() const     { return fEnabled; }
+
+    void BeginOfRun();
+    inline void ProcessStep(const G4Step* step);
+    void EndOfEvent();
+
+    void Write(const G4String& fileName, G4int nofEvents) const;
+
+  private:
+    void Score(const G4Step* step);
+    // mass of the scored content of a cell, sampled with n^3 points
+    G4double ComputeMass(G4Navigator* navigator, G4int ix, G4int iy,
+                         G4int iz, G4int n) const;
+
+    G4bool   fEnabled;
+    G4int    fNbBins[3];
+    G4ThreeVector fMin;
+    G4ThreeVector fBinSize;
+    G4double fBinVolume;
+
+    const G4Region* fPatientRegion;
+    const G4Region* fMoRegion;
+
+    B3HistoryTally fDose;
+
+    B3DoseGridMessenger* fMessenger;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B3DoseGrid::ProcessStep(const G4Step* step)
+{
+  if (fEnabled) Score(step);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
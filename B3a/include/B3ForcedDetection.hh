@@ -0,0 +1,143 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3ForcedDetection.hh
+/// \brief Definition of the B3ForcedDetection class
+
+#ifndef B3ForcedDetection_h
+#define B3ForcedDetection_h 1
+
+#include "B3HistoryTally.hh"
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class B3ForcedDetectionMessenger;
+class B3DetectorConstruction;
+class G4Region;
+class G4Step;
+
+/// Forced detection (next-event estimator) of the photons reaching the
+/// pixels of the ring.
+///
+/// At each vertex in the Patient and MoSolution regions where a photon
+/// leaves in a new direction, the expected contribution to every pixel is
+/// scored:  weight * p(direction) * solid angle * transmission * efficiency
+/// - photon emission (fluorescence, Auger-PIXE, any secondary photon except
+///   bremsstrahlung): isotropic, at the photon energy
+/// - Compton scattering of a photon: Klein-Nishina on a free electron,
+///   at the scattered energy
+/// The transmission is summed over an attenuation map, a grid of material
+/// indices over the patient built once per run by the master: the
+/// materials are found by descending the placements and reading the
+/// phantom parameterisation, without a navigator, so the shared
+/// parameterised volumes are never set up in the middle of a step. Outside
+/// the map the path is in the material of the world. The rays are walked
+/// cell by cell (Amanatides-Woo), with the attenuation coefficients
+/// tabulated in energy for the materials of the map only.
+/// The efficiency is the probability of a photoelectric absorption in the
+/// crystal thickness, so the forced spectra are full-energy deposits, in
+/// the same deposited energy bins as the analog spectra of the pixels;
+/// the partial deposits (Compton in the crystal, L escape) are only in the
+/// analog spectra. Coherent scattering is not forced.
+///
+/// Both spectra are binned per pixel with history-by-history errors and
+/// written by the master to <output>_fd.npy.
+
+class B3ForcedDetection
+{
+  public:
+    B3ForcedDetection();
+    ~B3ForcedDetection();
+
+    void SetEnabled(G4bool flag)      { fEnabled = flag; }
+    void SetNbBins(G4int nbBins)      { fNbBins = nbBins; }
+    void SetMaxEnergy(G4double emax)  { fMaxEnergy = emax; }
+    void SetMapCellSize(G4double size) { fMapCellSize = size; }
+    G4bool IsEnabled() const          { return fEnabled; }
+
+    // tracking is false for the master of a multi-threaded run
+    void BeginOfRun(G4bool tracking);
+    void ProcessStep(const G4Step* step);
+    void ScoreAnalog(G4int pixel, G4double edep);
+    void EndOfEvent();
+
+    void Write(const G4String& fileName, G4int nofEvents) const;
+
+  private:
+    void BuildMaterialMap();
+    void BuildAttenuationTable();
+    G4double Attenuation(size_t materialIndex, G4double energy) const;
+    G4double Transmission(const G4ThreeVector& start,
+                          const G4ThreeVector& direction,
+                          G4double distance, G4double energy) const;
+    void ScorePixels(const G4ThreeVector& vertex, G4double energy,
+                     G4double weight, const G4ThreeVector* incident);
+
+    G4bool   fEnabled;
+    G4int    fNbBins;
+    G4double fMaxEnergy;
+    G4double fMapCellSize;
+
+    const B3DetectorConstruction* fDetector;
+    G4int    fNbPixels;
+    std::vector<G4ThreeVector> fPixelEntrance;
+    std::vector<G4ThreeVector> fPixelDirection;
+    std::vector<G4bool>        fPixelActive;
+    G4double fPixelArea;
+    G4double fCrystalThickness;
+    size_t   fCrystalMaterialIndex;
+
+    const G4Region* fPatientRegion;
+    const G4Region* fMoRegion;
+
+    // total attenuation coefficient per material on a linear energy grid,
+    // for the materials of the map, of the world and of the crystals;
+    // photoelectric fraction in the crystals on the same grid
+    G4double fTableStep;
+    std::vector<std::vector<G4double> > fAttenuation;
+    std::vector<G4double> fPhotoFraction;
+
+    // attenuation map: index in fgMapMaterials per cell, x fastest;
+    // written by the master before the workers start the run
+    static G4ThreeVector fgMapMin;
+    static G4ThreeVector fgMapCell;
+    static G4int         fgMapBins[3];
+    static std::vector<unsigned short> fgMap;
+    static std::vector<size_t> fgMapMaterials;
+    static size_t        fgOutsideMaterial;
+
+    B3HistoryTally fForced;
+    B3HistoryTally fAnalog;
+
+    B3ForcedDetectionMessenger* fMessenger;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
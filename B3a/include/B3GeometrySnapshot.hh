@@ -0,0 +1,63 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3GeometrySnapshot.hh
+/// \brief Definition of the B3GeometrySnapshot class
+
+#ifndef B3GeometrySnapshot_h
+#define B3GeometrySnapshot_h 1
+
+#include "globals.hh"
+
+class G4VPhysicalVolume;
+class B3DetectorConstruction;
+
+/// GDML export of the constructed geometry, for external tools.
+///
+/// Write() exports the world with all its materials, the Mo solution
+/// included, so that external tools read the same geometry as the
+/// simulation. The detector parameters are attached to the world volume
+/// as auxiliary information. The voxels of a B3VoxelPhantom are left out:
+/// only their container is written, one GDML element per voxel being both
+/// larger and slower to read than the raw files of the phantom.
+///
+/// The snapshot is export-only, not the authoritative geometry: reading it
+/// back would not make the startup faster, the crystals and the voxels
+/// having to be placed again.
+///
+/// GDML is only available when Geant4 was built with it (B3_USE_GDML);
+/// otherwise Write() stops with an exception.
+
+class B3GeometrySnapshot
+{
+  public:
+    static void Write(const G4String& fileName, G4VPhysicalVolume* world,
+                      const B3DetectorConstruction* detector);
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,90 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3HistoryTally.hh
+/// \brief Definition of the B3HistoryTally class
+
+#ifndef B3HistoryTally_h
+#define B3HistoryTally_h 1
+
+#include "G4VAccumulable.hh"
+#include "globals.hh"
+
+#include <iosfwd>
+#include <vector>
+
+/// Accumulable array of scores with history-by-history variance.
+///
+/// Score() adds to a per-history scratch array and records the touched
+/// bins; EndOfHistory() moves the history totals x into the sums of x and
+/// x*x and clears only the touched bins. The arrays are allocated once by
+/// SetSize(); the master copy takes its size from the first merged worker.
+/// Save() and Restore() write and add back the sums for checkpoints.
+
+class B3HistoryTally : public G4VAccumulable
+{
+  public:
+    B3HistoryTally(const G4String& name);
+    virtual ~B3HistoryTally();
+
+    void   SetSize(size_t size);
+    size_t GetSize() const { return fSum.size(); }
+
+    inline void Score(size_t index, G4double value);
+    void EndOfHistory();
+
+    virtual void Merge(const G4VAccumulable& other);
+    virtual void Reset();
+
+    void   Save(std::ostream& output) const;
+    G4bool Restore(std::istream& input);
+
+    const std::vector<G4double>& GetSum()  const { return fSum; }
+    const std::vector<G4double>& GetSum2() const { return fSum2; }
+
+    // mean per history and its standard error
+    void GetMeanAndError(G4int nofHistories,
+                         G4double* mean, G4double* error) const;
+
+  private:
+    std::vector<G4double> fSum;
+    std::vector<G4double> fSum2;
+    std::vector<G4double> fHistory;
+    std::vector<size_t>   fTouched;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B3HistoryTally::Score(size_t index, G4double value)
+{
+  if (value <= 0.) return;
+  if (fHistory[index] == 0.) fTouched.push_back(index);
+  fHistory[index] += value;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
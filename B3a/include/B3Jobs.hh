@@ -0,0 +1,79 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3Jobs.hh
+/// \brief Definition of the B3Jobs class
+
+#ifndef B3Jobs_h
+#define B3Jobs_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+/// Local multi-process driver (--jobs N of the program).
+///
+/// Fork() starts N copies of the process before any Geant4 object is
+/// built. Each job runs its share of the events with its own seed and
+/// output name <output>_job<k>, logs to <output>_job<k>.log and, on Linux,
+/// is bound to a contiguous slice of the CPUs of the parent, so that the
+/// jobs spread over the sockets of a NUMA node, each with its own memory.
+/// The parent waits for the jobs and merges their .npy outputs into
+/// <output>_*.npy: histograms and spectral cubes are summed, the dose
+/// grid and forced detection (mean, error) arrays are averaged with the
+/// events each job processed, read from the <output>_job<k>.events file
+/// written next to its outputs, and their errors combined (B3NpyMerge).
+/// The analysis files and the list-mode files stay per job.
+
+class B3Jobs
+{
+  public:
+    B3Jobs(G4int nofJobs, const G4String& outputName, G4int nofEvents);
+    ~B3Jobs();
+
+    // index of the job in the child processes; -1 in the parent, after
+    // all the jobs are done and merged
+    G4int Fork();
+
+    G4int    GetNofEvents(G4int job) const;
+    G4String GetOutputName(G4int job) const;
+    G4int    GetNofCpus() const    { return fNofCpus; }
+    G4bool   IsSuccessful() const  { return fSuccessful; }
+
+  private:
+    void   BindCpus(G4int job);
+    G4bool Merge() const;
+
+    G4int    fNofJobs;
+    G4String fOutputName;
+    G4int    fNofEvents;
+    G4int    fNofCpus;
+    G4bool   fSuccessful;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
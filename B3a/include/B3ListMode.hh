@@ -0,0 +1,136 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3ListMode.hh
+/// \brief Definition of the B3ListMode class
+
+#ifndef B3ListMode_h
+#define B3ListMode_h 1
+
+#include "B3SpscQueue.hh"
+#include "globals.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class B3ListModeMessenger;
+
+/// One pixel deposit of one event, 20 bytes, little endian.
+/// The flags are the B3TrackOrigin flags of the deposit.
+
+struct B3ListModeRecord
+{
+  G4int   eventID;
+  G4int   pixel;      // ring*nbCrystals + crystal
+  G4float edep;       // keV
+  G4float time;       // ns, first deposit in the pixel
+  G4int   flags;
+};
+
+/// List-mode output of the pixel deposits.
+///
+/// The event action adds the records to a chunk; a full chunk is handed to
+/// a writer thread through a lock-free queue, and the writer hands the
+/// written chunks back for reuse. The tracking thread never waits on the
+/// disk: if the writer falls behind, the chunks pile up in memory.
+///
+/// Each tracking thread writes its own file:
+///   header  "B3LM", uint32 version (1), record size (20), compression
+///           (0 raw, 1 zlib)
+///   chunks  uint32 number of records, uint32 number of bytes, the bytes
+/// Compression needs zlib at build time (B3_USE_ZLIB). The digitize
+/// program reads the files back.
+
+class B3ListMode
+{
+  public:
+    B3ListMode();
+    ~B3ListMode();
+
+    void SetEnabled(G4bool flag)        { fEnabled = flag; }
+    void SetCompression(G4int level)    { fCompression = level; }
+    void SetChunkSize(G4int nbRecords)  { fChunkSize = nbRecords; }
+    G4bool IsEnabled() const            { return fEnabled; }
+
+    // the master of a multi-threaded run writes nothing
+    void BeginOfRun(const G4String& fileName);
+    inline void AddRecord(G4int eventID, G4int pixel, G4double edep,
+                          G4double time, G4int flags);
+    void EndOfRun();
+
+  private:
+    typedef std::vector<B3ListModeRecord> Chunk;
+
+    void Submit();
+    void WriterLoop();
+    void WriteChunk(const Chunk& chunk);
+
+    G4bool fEnabled;
+    G4int  fCompression;
+    size_t fChunkSize;
+
+    // tracking thread side
+    Chunk*             fCurrent;
+    std::deque<Chunk*> fBacklog;
+    std::vector<Chunk*> fChunks;
+    G4long             fNbRecords;
+
+    // writer thread side
+    G4bool                  fCompressed;
+    B3SpscQueue<Chunk*>     fFull;
+    B3SpscQueue<Chunk*>     fFree;
+    std::thread             fWriter;
+    std::atomic<bool>       fStop;
+    std::mutex              fMutex;
+    std::condition_variable fWakeUp;
+    std::ofstream           fOutput;
+    std::vector<char>       fBuffer;
+    G4long                  fNbBytes;
+
+    B3ListModeMessenger* fMessenger;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B3ListMode::AddRecord(G4int eventID, G4int pixel, G4double edep,
+                                  G4double time, G4int flags)
+{
+  if (!fCurrent) return;
+  B3ListModeRecord record = { eventID, pixel, G4float(edep/CLHEP::keV),
+                              G4float(time/CLHEP::ns), flags };
+  fCurrent->push_back(record);
+  if (fCurrent->size() >= fChunkSize) Submit();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
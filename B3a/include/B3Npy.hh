@@ -0,0 +1,90 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3Npy.hh
+/// \brief Definition of the B3Npy class
+
+#ifndef B3Npy_h
+#define B3Npy_h 1
+
+#include "globals.hh"
+
+#include <fstream>
+#include <vector>
+
+/// Writer of arrays in the NumPy .npy format (version 1.0, little endian,
+/// C order), which numpy.load() reads, or maps with mmap_mode, directly.
+/// ReadHeader() reads back the type and shape of such a file, leaving the
+/// stream at the start of the data.
+
+class B3Npy
+{
+  public:
+    template <typename T>
+    static G4bool Write(const G4String& fileName,
+                        const std::vector<size_t>& shape, const T* data);
+
+    static void WriteHeader(std::ostream& output, const G4String& descr,
+                            const std::vector<size_t>& shape);
+    static G4bool ReadHeader(std::istream& input, G4String& descr,
+                             std::vector<size_t>& shape);
+
+    template <typename T> static const char* Descr();
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+template <> inline const char* B3Npy::Descr<G4double>() { return "<f8"; }
+template <> inline const char* B3Npy::Descr<G4float>()  { return "<f4"; }
+template <> inline const char* B3Npy::Descr<G4int>()    { return "<i4"; }
+template <> inline const char* B3Npy::Descr<unsigned int>()  { return "<u4"; }
+template <> inline const char* B3Npy::Descr<unsigned char>() { return "|u1"; }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+template <typename T>
+G4bool B3Npy::Write(const G4String& fileName,
+                    const std::vector<size_t>& shape, const T* data)
+{
+  std::ofstream output(fileName, std::ios::binary);
+  if ( ! output ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open " << fileName << " for writing.";
+    G4Exception("B3Npy::Write()", "MyCode0004", JustWarning, msg);
+    return false;
+  }
+
+  size_t size = 1;
+  for (size_t i = 0; i < shape.size(); ++i) size *= shape[i];
+
+  WriteHeader(output, Descr<T>(), shape);
+  output.write(reinterpret_cast<const char*>(data), size*sizeof(T));
+  return output.good();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,58 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3NpyMerge.hh
+/// \brief Definition of the B3NpyMerge class
+
+#ifndef B3NpyMerge_h
+#define B3NpyMerge_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+/// Merge of the .npy arrays written by separate jobs of the same setup.
+///
+/// Sum() adds arrays of the same shape and type (<u4, <i4 or <f8): spectral
+/// cubes and histograms; the integer types are summed in 64 bits and
+/// checked for overflow. Average() merges the arrays whose first axis
+/// alternates mean and standard error planes per event (dose grid, forced
+/// detection): the means are weighted by the number of events of each job
+/// and the errors combined in quadrature with the same weights.
+
+class B3NpyMerge
+{
+  public:
+    static G4bool Sum(const G4String& output,
+                      const std::vector<G4String>& inputs);
+    static G4bool Average(const G4String& output,
+                          const std::vector<G4String>& inputs,
+                          const std::vector<G4double>& nofEvents);
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
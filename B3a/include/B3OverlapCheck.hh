@@ -0,0 +1,84 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3OverlapCheck.hh
+/// \brief Definition of the B3OverlapCheck class
+
+#ifndef B3OverlapCheck_h
+#define B3OverlapCheck_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <vector>
+
+class G4VPhysicalVolume;
+
+/// Overlap check of the whole geometry, once it is constructed.
+///
+/// The volumes are placed without checking; Check() then runs
+/// G4VPhysicalVolume::CheckOverlaps() on all of them, on the master
+/// thread: the placements and the solids are thread-split data, only set
+/// up for the threads of the run manager.
+///
+/// The geometry is identified by a hash of the solids, placements and
+/// copy numbers of the tree. A geometry found without overlaps is added to
+/// a cache file, and the check is skipped when the same hash is found
+/// there again, unless forced. The regular voxels of the phantom are not
+/// checked: they fill their container by construction.
+
+class B3OverlapCheck
+{
+  public:
+    B3OverlapCheck();
+    ~B3OverlapCheck();
+
+    void SetEnabled(G4bool value)            { fEnabled = value; }
+    void SetForced(G4bool value)             { fForced = value; }
+    void SetCacheFile(const G4String& name)  { fCacheFile = name; }
+    G4bool IsEnabled() const                 { return fEnabled; }
+
+    void Check(G4VPhysicalVolume* world) const;
+
+  private:
+    typedef std::vector<G4VPhysicalVolume*> Volumes;
+
+    // all the volumes below the world, and those to check
+    static void CollectVolumes(G4VPhysicalVolume* world,
+                               Volumes& volumes, Volumes& checked);
+    static std::uint64_t Hash(const Volumes& volumes);
+    G4bool IsCached(std::uint64_t hash) const;
+    void   AddToCache(std::uint64_t hash) const;
+
+    G4bool   fEnabled;
+    G4bool   fForced;
+    G4int    fResolution;
+    G4String fCacheFile;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
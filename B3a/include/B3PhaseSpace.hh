@@ -0,0 +1,138 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3PhaseSpace.hh
+/// \brief Definition of the B3PhaseSpace class
+
+#ifndef B3PhaseSpace_h
+#define B3PhaseSpace_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+class B3PhaseSpaceMessenger;
+class G4Event;
+class G4Step;
+
+/// One particle leaving the patient, 44 bytes, little endian.
+
+struct B3PhaseSpaceRecord
+{
+  G4int   eventID;
+  G4int   pdg;          // PDG encoding, ions as 100ZZZAAAI
+  G4float energy;       // keV, kinetic
+  G4float time;         // ns, global
+  G4float position[3];  // mm
+  G4float direction[3];
+  G4float weight;
+};
+
+/// Phase space of the particles leaving the patient, recorded and replayed.
+///
+/// Recording: each tracking thread writes a record for every particle
+/// crossing the outer surface of PatientLV (from the patient or one of its
+/// daughters to a volume outside it) and, by default, kills it there, so
+/// that the run tracks the patient side only. Files:
+///   header  "B3PS", uint32 version (1), record size (44),
+///           uint64 number of histories simulated by the thread
+///   records in the order of the events, those of an event consecutive
+/// named <output>_ps_t<thread>.bin (<output>_ps.bin in sequential mode).
+///
+/// Replay: the master indexes the files of a recording, given by its
+/// output name, and event i of the replay run generates the particles
+/// recorded by event i of the recording, whatever the threads of either
+/// run. A replay of as many events as the recording keeps its
+/// normalisation; a longer one reuses the histories.
+
+class B3PhaseSpace
+{
+  public:
+    B3PhaseSpace();
+    ~B3PhaseSpace();
+
+    void SetRecording(G4bool flag)        { fRecording = flag; }
+    void SetKill(G4bool flag)             { fKill = flag; }
+    void SetReplay(const G4String& name)  { fReplayName = name; }
+    G4bool IsRecording() const            { return fRecording; }
+    G4bool IsReplaying() const            { return !fReplayName.empty(); }
+
+    // the master indexes the replayed files,
+    // the tracking threads open their recording
+    void BeginOfRun(const G4String& runName, G4int nofEvents,
+                    G4bool master, G4bool tracking);
+    inline void ProcessStep(const G4Step* step);
+    void EndOfRun(G4int nofEvents);
+
+    void GeneratePrimaries(G4Event* event);
+
+  private:
+    struct History {
+      G4int         eventID;
+      G4int         file;
+      G4int         nofRecords;
+      std::uint64_t offset;
+      bool operator<(const History& other) const
+        { return eventID < other.eventID; }
+    };
+
+    void Record(const G4Step* step);
+    void Flush();
+    G4bool Index(const G4String& fileName, G4int file);
+    std::vector<G4String> FindFiles() const;
+
+    G4bool   fRecording;
+    G4bool   fKill;
+    G4String fReplayName;
+
+    // recording
+    std::vector<char> fInPatient;   // by logical volume instance ID
+    std::vector<B3PhaseSpaceRecord> fRecords;
+    std::ofstream fOutput;
+
+    // replay: files opened by each thread on demand
+    std::vector<std::ifstream*> fInputs;
+
+    // shared by the threads, set by the master before the workers start
+    static std::vector<G4String> fgFiles;
+    static std::vector<History>  fgHistories;
+    static std::uint64_t         fgNofHistories;
+
+    B3PhaseSpaceMessenger* fMessenger;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B3PhaseSpace::ProcessStep(const G4Step* step)
+{
+  if (fOutput.is_open()) Record(step);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
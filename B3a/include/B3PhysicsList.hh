@@ -31,21 +31,44 @@
 #define B3PhysicsList_h 1
 
 #include "G4VModularPhysicsList.hh"
+#include "globals.hh"
 
-/// Modular physics list
+class G4VPhysicsConstructor;
+class B3PhysicsListMessenger;
+
+/// Electromagnetic-only modular physics list for the low energy
+/// X-ray fluorescence set-up.
+///
+/// It includes one of the following EM builders, selected in the
+/// constructor or with /B3/phys/em (PreInit state only):
+/// - livermore : G4EmLivermorePhysics (default)
+/// - penelope  : G4EmPenelopePhysics
+/// - option4   : G4EmStandardPhysics_option4
 ///
-/// It includes the folowing physics builders
-/// - G4DecayPhysics
-/// - G4RadioactiveDecayPhysics
-/// - G4EmStandardPhysics
+/// G4RadioactiveDecayPhysics can be added with /B3/phys/radioactiveDecay.
+/// Atomic de-excitation (fluo, Auger, PIXE) is steered with the
+/// standard /process/em/ commands.
 
 class B3PhysicsList: public G4VModularPhysicsList
 {
 public:
-  B3PhysicsList();
+  B3PhysicsList(const G4String& emName = "livermore");
   virtual ~B3PhysicsList();
 
   virtual void SetCuts();
+
+  void SelectEmPhysics(const G4String& name);
+  void SetRadioactiveDecay(G4bool flag);
+
+  const G4String& GetEmName() const { return fEmName; }
+  G4bool GetRadioactiveDecay() const { return (fRadioactiveDecay != 0); }
+
+  static G4bool IsEmPhysicsName(const G4String& name);
+
+private:
+  G4String               fEmName;
+  G4VPhysicsConstructor* fRadioactiveDecay;
+  B3PhysicsListMessenger* fMessenger;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
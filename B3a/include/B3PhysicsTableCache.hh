@@ -0,0 +1,100 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3PhysicsTableCache.hh
+/// \brief Definition of the B3PhysicsTableCache class
+
+#ifndef B3PhysicsTableCache_h
+#define B3PhysicsTableCache_h 1
+
+#include "G4VStateDependent.hh"
+#include "G4Timer.hh"
+#include "globals.hh"
+
+#include <cstdint>
+
+class G4VUserPhysicsList;
+class B3PhysicsTableCacheMessenger;
+
+/// Store and retrieval of the physics tables of the master, keyed by what
+/// they depend on.
+///
+/// The kernel builds the tables at the start of a run, between the Idle to
+/// Init and the Idle to GeomClosed state changes. At the first one, the
+/// key is computed as a hash of the Geant4 version and data sets, of the
+/// processes and EM models of every particle, of the EM parameters, of the
+/// production cuts of every region and of the whole material table, which
+/// the cuts table of Geant4 compares too. If <cacheDirectory>/<key> holds
+/// a complete set of tables, they are retrieved; otherwise they are built
+/// as usual and stored there at the second change. A mismatch thus gives
+/// another key and a rebuild, and a process whose table cannot be read is
+/// built by Geant4.
+///
+/// A set is written in a temporary directory, renamed when complete, so
+/// that concurrent jobs never read a partial set. It records the time and
+/// the resident memory taken to build it, and the saving of a retrieval
+/// is printed. The workers build their tables from those of the master,
+/// as without the cache.
+///
+/// Set with /B3/tables/cacheDirectory, B3tables by default; none to
+/// always build the tables.
+
+class B3PhysicsTableCache : public G4VStateDependent
+{
+  public:
+    B3PhysicsTableCache(G4VUserPhysicsList* physicsList);
+    virtual ~B3PhysicsTableCache();
+
+    void SetDirectory(const G4String& name) { fDirectory = name; }
+
+    virtual G4bool Notify(G4ApplicationState requestedState);
+
+  private:
+    std::uint64_t Hash() const;
+    void BeginTables();
+    void EndTables();
+    G4bool Store(G4double buildTime, G4double buildMemory) const;
+
+    // resident memory of the process in MB, 0 if unknown
+    static G4double ResidentMemory();
+    static void RemoveDirectory(const G4String& name);
+
+    G4VUserPhysicsList* fPhysicsList;
+    G4String fDirectory;
+    std::uint64_t fKey;          // of the tables in memory
+    G4bool   fHasKey;
+    G4bool   fPending;           // tables being built or retrieved
+    std::uint64_t fPendingKey;
+    G4String fTableDirectory;
+    G4bool   fRetrieved;
+    G4Timer  fTimer;
+    G4double fMemory;
+    B3PhysicsTableCacheMessenger* fMessenger;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
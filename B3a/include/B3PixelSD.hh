@@ -0,0 +1,93 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3PixelSD.hh
+/// \brief Definition of the B3PixelSD class
+
+#ifndef B3PixelSD_h
+#define B3PixelSD_h 1
+
+#include "G4VSensitiveDetector.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4Step;
+class G4HCofThisEvent;
+class G4TouchableHistory;
+
+/// Pixel sensitive detector.
+///
+/// Energy deposits in the crystals are summed into a flat array indexed by
+/// pixel = ring*nbCrystals + crystal, with the crystal copy number taken at
+/// depth 0 and the ring copy number at depth 1 of the touchable.
+/// The array is allocated once per thread; only the pixels touched in the
+/// previous event are cleared in Initialize().
+/// Each pixel also keeps the global time of its first deposit and the
+/// B3TrackOrigin flags of all the tracks depositing in it.
+/// Dead pixels, such as the beam hole, ignore their deposits.
+
+class B3PixelSD : public G4VSensitiveDetector
+{
+  public:
+    B3PixelSD(const G4String& name, G4int nbCrystals, G4int nbRings);
+    virtual ~B3PixelSD();
+
+    virtual void   Initialize(G4HCofThisEvent*);
+    virtual G4bool ProcessHits(G4Step*, G4TouchableHistory*);
+
+    // new pixel array, all alive, for a rebuilt geometry
+    void SetSize(G4int nbCrystals, G4int nbRings);
+    void SetDeadPixel(G4int pixel) { fDead[pixel] = true; }
+
+    // deposit not coming from a step, as from B3ResponseModel
+    void AddDeposit(G4int pixel, G4double edep, G4double time, G4int flags);
+
+    G4int GetNbCrystals() const { return fNbCrystals; }
+    G4int GetNbRings()    const { return fNbRings; }
+    G4int GetNbPixels()   const { return fNbCrystals*fNbRings; }
+
+    G4int GetCrystal(G4int pixel) const { return pixel % fNbCrystals; }
+    G4int GetRing(G4int pixel)    const { return pixel / fNbCrystals; }
+
+    const std::vector<G4int>& GetTouchedPixels() const { return fTouched; }
+    G4double GetEdep(G4int pixel) const { return fEdep[pixel]; }
+    G4double GetTime(G4int pixel) const { return fTime[pixel]; }
+    G4int    GetFlags(G4int pixel) const { return fFlags[pixel]; }
+
+  private:
+    G4int fNbCrystals;
+    G4int fNbRings;
+    std::vector<G4double> fEdep;
+    std::vector<G4double> fTime;
+    std::vector<G4int>    fFlags;
+    std::vector<G4bool>   fDead;
+    std::vector<G4int>    fTouched;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
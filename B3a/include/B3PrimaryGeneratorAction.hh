@@ -34,6 +34,7 @@
 #include "G4ParticleGun.hh"
 #include "globals.hh"
 
+class B3aRunAction;
 class G4ParticleGun;
 class G4Event;
 class G4Box;
@@ -43,11 +44,13 @@ class G4Box;
 /// It defines an ion (F18), at rest, randomly distribued within a zone 
 /// in a patient defined in GeneratePrimaries(). Ion F18 can be changed 
 /// with the G4ParticleGun commands (see run2.mac).
+/// With /B3/phaseSpace/replay, the events replay a recorded phase space
+/// instead (see B3PhaseSpace).
 
 class B3PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
 {
   public:
-    B3PrimaryGeneratorAction();    
+    B3PrimaryGeneratorAction(B3aRunAction* runAction);
     virtual ~B3PrimaryGeneratorAction();
 
     virtual void GeneratePrimaries(G4Event*);         
@@ -55,6 +58,7 @@ class B3PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
     const G4ParticleGun* GetParticleGun() const { return fParticleGun; }
   
   private:
+    B3aRunAction*   fRunAction;
     G4ParticleGun*  fParticleGun;
     G4Box* fWorld;
 };
@@ -0,0 +1,101 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3Reproducibility.hh
+/// \brief Definition of the B3Reproducibility class
+
+#ifndef B3Reproducibility_h
+#define B3Reproducibility_h 1
+
+#include "globals.hh"
+#include "G4Threading.hh"
+
+#include <map>
+#include <string>
+
+class B3ReproducibilityMessenger;
+
+/// Reproducible mode: results independent of the number of threads.
+///
+/// The random engine is reseeded at each event from the run seed and the
+/// event ID only, where the run seed is derived from /B3/reproducible/seed
+/// and the run ID. The events are grouped in blocks of consecutive IDs,
+/// and the master run manager hands them out one block at a time
+/// (/run/eventModulo); at the first event of the next block, a thread
+/// saves its accumulables and histograms (B3RunState) as the partial sums
+/// of the block and resets them. At end of run the master adds the saved
+/// blocks in the order of their index, whatever the thread that completed
+/// them. So the floating-point sums are done in a fixed order, and the
+/// outputs of a sequential run and of runs with any number of threads are
+/// bit-identical.
+///
+/// The MT run manager lowers the event modulo to events/threads, which
+/// would split the blocks between threads: a run of fewer events than
+/// threads times the block size is refused. The saved blocks are kept in
+/// memory until the end of run, one state each, so the block size should
+/// not be much smaller than needed.
+///
+/// Not combined with the checkpoints, which save the state of the threads.
+
+class B3Reproducibility
+{
+  public:
+    B3Reproducibility();
+    ~B3Reproducibility();
+
+    void SetEnabled(G4bool flag)     { fEnabled = flag; }
+    void SetSeed(G4long seed)        { fSeed = seed; }
+    void SetBlockSize(G4int nbEvents) { fBlockSize = nbEvents; }
+    G4bool IsEnabled() const         { return fEnabled; }
+
+    void BeginOfRun(G4int runID, G4bool master);
+    void BeginOfEvent(G4int eventID);
+    void EndOfRun(G4bool master);
+
+    // called by the primary generator before any random number is drawn
+    static void SeedEvent(G4int eventID);
+
+  private:
+    void Flush();
+
+    G4bool fEnabled;
+    G4long fSeed;
+    G4int  fBlockSize;
+    G4int  fBlock;
+
+    // shared by the threads; the run seed is set by the master before the
+    // workers start, the rest is guarded by the mutex
+    static G4long  fgRunSeed;
+    static G4Mutex fgMutex;
+    static std::multimap<G4int, std::string> fgBlocks;
+    static G4bool  fgOrdered;
+
+    B3ReproducibilityMessenger* fMessenger;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
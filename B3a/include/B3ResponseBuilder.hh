@@ -0,0 +1,86 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3ResponseBuilder.hh
+/// \brief Definition of the B3ResponseBuilder class
+
+#ifndef B3ResponseBuilder_h
+#define B3ResponseBuilder_h 1
+
+#include "B3ResponseLibrary.hh"
+#include "G4Threading.hh"
+#include "globals.hh"
+
+class B3ResponseBuilderMessenger;
+class B3PixelSD;
+class G4Event;
+
+/// Build of a B3ResponseLibrary by full simulation of the crystal ring.
+///
+/// In a build run, event i shoots one photon at a uniform random point of
+/// library bin i modulo the number of bins, into the cell of a reference
+/// crystal away from the beam hole (central ring, crystal nbCrystals/2),
+/// so that each bin receives the same number of photons. At the end of
+/// the event the pixel deposits become an outcome of the bin, as offsets
+/// from the reference crystal. The threads merge their outcomes at end of
+/// run and the master writes the library for the current crystal cell,
+/// to the file given with /B3/response/build.
+
+class B3ResponseBuilder
+{
+  public:
+    B3ResponseBuilder();
+    ~B3ResponseBuilder();
+
+    void SetFileName(const G4String& name) { fFileName = name; }
+    void SetNbBins(const G4int nbBins[B3ResponseLibrary::kNofAxes]);
+    void SetMaxEnergy(G4double energy)     { fMaxEnergy = energy; }
+    G4bool IsEnabled() const               { return !fFileName.empty(); }
+
+    void BeginOfRun(G4bool master);
+    void GeneratePrimaries(G4Event* event);
+    void EndOfEvent(const G4Event* event, const B3PixelSD* pixelSD);
+    void EndOfRun(G4bool master, G4bool tracking);
+
+  private:
+    G4String fFileName;
+    G4int    fNbBins[B3ResponseLibrary::kNofAxes];
+    G4double fMaxEnergy;
+
+    B3ResponseLibrary* fLibrary;
+    G4int fReferenceRing;
+    G4int fReferenceCrystal;
+
+    // outcomes of all the threads, written by the master
+    static G4Mutex fgMutex;
+    static B3ResponseLibrary* fgLibrary;
+
+    B3ResponseBuilderMessenger* fMessenger;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,65 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3ResponseBuilderMessenger.hh
+/// \brief Definition of the B3ResponseBuilderMessenger class
+
+#ifndef B3ResponseBuilderMessenger_h
+#define B3ResponseBuilderMessenger_h 1
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class B3ResponseBuilder;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWithADoubleAndUnit;
+
+/// Messenger of B3ResponseBuilder.
+///
+/// Each thread has its own instance; the commands are broadcast.
+
+class B3ResponseBuilderMessenger: public G4UImessenger
+{
+  public:
+    B3ResponseBuilderMessenger(B3ResponseBuilder* builder);
+    virtual ~B3ResponseBuilderMessenger();
+
+    virtual void SetNewValue(G4UIcommand*, G4String);
+
+  private:
+    B3ResponseBuilder*         fBuilder;
+
+    G4UIdirectory*             fDirectory;
+    G4UIcmdWithAString*        fBuildCmd;
+    G4UIcommand*               fNbBinsCmd;
+    G4UIcmdWithADoubleAndUnit* fMaxEnergyCmd;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
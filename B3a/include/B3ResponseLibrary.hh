@@ -0,0 +1,121 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3ResponseLibrary.hh
+/// \brief Definition of the B3ResponseLibrary class
+
+#ifndef B3ResponseLibrary_h
+#define B3ResponseLibrary_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <vector>
+
+class B3DetectorConstruction;
+
+/// Response of the crystal ring to the photons entering a crystal face.
+///
+/// The library is binned in the photon energy, the entry point on the face
+/// of the crystal cell (u across the crystals of a ring, v along the
+/// rings, both over the full pitch with the gap), the cosine of the angle
+/// to the face normal and the azimuth around it. Each bin holds the
+/// outcomes of fully simulated photons: the deposits in the pixels, as
+/// offsets from the entered crystal. A deposit of more than half the
+/// photon energy is kept as its deficit, stored as a negative or zero
+/// value, so that the photopeak and the escape peaks stay sharp for any
+/// energy in the bin.
+///
+/// The library is built by B3ResponseBuilder and replayed by
+/// B3ResponseModel; its file records the cell it was built for.
+
+class B3ResponseLibrary
+{
+  public:
+    enum Axis { kEnergy, kU, kV, kCosTheta, kAzimuth, kNofAxes };
+
+    struct Deposit {
+      std::int16_t dCrystal;
+      std::int16_t dRing;
+      G4float      edep;      // keV if > 0, else minus the deficit
+    };
+
+    B3ResponseLibrary();
+    ~B3ResponseLibrary();
+
+    // binning and cell, before any outcome
+    void SetBinning(const G4int nbBins[kNofAxes], G4double maxEnergy);
+    void SetCell(const B3DetectorConstruction* detector);
+    G4bool MatchesCell(const B3DetectorConstruction* detector) const;
+
+    G4int    GetNbBins() const;
+    G4double GetMaxEnergy() const { return fMaxEnergy; }
+    G4double GetPitchU() const    { return fPitchU; }
+    G4double GetPitchV() const    { return fPitchV; }
+
+    // -1 outside the library
+    G4int GetBin(G4double energy, G4double u, G4double v,
+                 G4double cosTheta, G4double azimuth) const;
+    // uniform random point in a bin, in the order of Axis
+    void  SampleInBin(G4int bin, G4double values[kNofAxes]) const;
+
+    // building
+    void AddOutcome(G4int bin, const std::vector<Deposit>& deposits);
+    void Merge(const B3ResponseLibrary& other);
+    size_t GetNbOutcomes() const { return fOutcomeBin.size(); }
+
+    // replay: the deposits of a random outcome of the bin,
+    // none if the bin has no outcome
+    const Deposit* Sample(G4int bin, size_t& nbDeposits) const;
+
+    G4bool Write(const G4String& fileName) const;
+    G4bool Read(const G4String& fileName);
+
+    // one library per file, shared by the threads
+    static const B3ResponseLibrary* Load(const G4String& fileName);
+
+  private:
+    G4int    fNbBins[kNofAxes];
+    G4double fMaxEnergy;
+
+    // crystal cell
+    G4double fPitchU;
+    G4double fPitchV;
+    G4double fThickness;
+    G4double fGap;
+    G4int    fNbCrystals;
+    G4String fMaterial;
+
+    // outcomes, grouped by bin once read
+    std::vector<G4int>         fOutcomeBin;
+    std::vector<std::uint64_t> fOutcomeStart;
+    std::vector<Deposit>       fDeposits;
+    std::vector<std::uint64_t> fBinStart;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
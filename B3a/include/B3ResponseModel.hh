@@ -0,0 +1,83 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3ResponseModel.hh
+/// \brief Definition of the B3ResponseModel class
+
+#ifndef B3ResponseModel_h
+#define B3ResponseModel_h 1
+
+#include "G4VFastSimulationModel.hh"
+#include "globals.hh"
+
+class B3ResponseLibrary;
+class B3DetectorConstruction;
+class B3PixelSD;
+class G4Region;
+
+/// Fast simulation of the crystal ring from a B3ResponseLibrary.
+///
+/// The model is attached to the "Detector" region. A photon entering the
+/// region through its inner surface is moved in a straight line to the
+/// face of the crystal it points to; the bin of its energy, entry point and
+/// direction gives a random outcome of the library, whose deposits are
+/// added to the pixels around that crystal, and the photon is killed.
+/// Photons out of the library (energy above its maximum, or entering
+/// through the ends of the ring) are tracked as usual, and so are the
+/// photons aimed at the beam hole.
+
+class B3ResponseModel : public G4VFastSimulationModel
+{
+  public:
+    B3ResponseModel(const B3ResponseLibrary* library,
+                    const B3DetectorConstruction* detector,
+                    B3PixelSD* pixelSD, G4Region* envelope);
+    virtual ~B3ResponseModel();
+
+    virtual G4bool IsApplicable(const G4ParticleDefinition& particle);
+    virtual G4bool ModelTrigger(const G4FastTrack& fastTrack);
+    virtual void   DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep);
+
+  private:
+    const B3ResponseLibrary* fLibrary;
+    B3PixelSD* fPixelSD;
+
+    G4int    fNbCrystals;
+    G4int    fNbRings;
+    G4double fInnerRadius;
+    G4double fPitchU;
+    G4double fPitchV;
+
+    // found by ModelTrigger for DoIt
+    G4int    fBin;
+    G4int    fCrystal;
+    G4int    fRing;
+    G4double fFlightLength;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
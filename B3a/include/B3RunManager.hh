@@ -0,0 +1,142 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3RunManager.hh
+/// \brief Definition of the B3ChunkedRunManager class
+
+#ifndef B3RunManager_h
+#define B3RunManager_h 1
+
+#include "G4Types.hh"
+
+#ifdef G4MULTITHREADED
+
+#include "G4MTRunManager.hh"
+#include "G4Version.hh"
+#include "G4AutoLock.hh"
+#include "G4Threading.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+
+/// Multi-threaded run manager handing out chunks of events sized by their
+/// measured cost, instead of the static default event modulo.
+///
+/// Each worker asks for its next chunk when the previous one is done, so
+/// the time between two requests of a thread, divided by the size of its
+/// chunk, is the cost of its events. The chunk given is the smaller of
+/// the events done in kChunkTime at the mean cost so far, and of the
+/// remaining events over twice the number of threads (guided scheduling),
+/// so the chunks shrink at the end of the run and the workers finish
+/// together even with the long Auger and PIXE tails; the first chunk of a
+/// thread is one event. A fixed modulo, /run/eventModulo or the
+/// reproducible mode, is used as is.
+///
+/// Instantiated for G4MTRunManager only. The task-based G4TaskRunManager
+/// sizes its tasks from numberOfEventsPerTask and seeds them per task, so
+/// a chunk written in eventModulo would not match its seeds; it is used
+/// as is, with its own static chunks.
+
+template <class Base>
+class B3ChunkedRunManager : public Base
+{
+  public:
+    B3ChunkedRunManager()
+      : Base(), fMeasuredTime(0.), fMeasuredEvents(0.) {}
+    virtual ~B3ChunkedRunManager() {}
+
+    virtual G4int SetUpNEvents(G4Event* event, G4SeedsQueue* seedsQueue,
+                               G4bool reseedRequired = true);
+
+  private:
+    typedef std::chrono::steady_clock Clock;
+    struct Request {
+      Clock::time_point time;
+      G4int nofEvents;
+    };
+
+    static constexpr G4double kChunkTime = 0.05;   // seconds
+
+    G4Mutex  fMutex;
+    std::map<G4int, Request> fLastRequest;
+    G4double fMeasuredTime;
+    G4double fMeasuredEvents;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+template <class Base>
+G4int B3ChunkedRunManager<Base>::SetUpNEvents(G4Event* event,
+                                              G4SeedsQueue* seedsQueue,
+                                              G4bool reseedRequired)
+{
+  if (this->GetEventModulo() > 0) {
+    return Base::SetUpNEvents(event, seedsQueue, reseedRequired);
+  }
+
+  G4AutoLock lock(&fMutex);
+  Clock::time_point now = Clock::now();
+  if (this->numberOfEventProcessed == 0) {
+    fLastRequest.clear();
+    fMeasuredTime = 0.;
+    fMeasuredEvents = 0.;
+  }
+
+  // cost of the chunk just done by this thread
+  G4int thread = G4Threading::G4GetThreadId();
+  typename std::map<G4int, Request>::iterator last = fLastRequest.find(thread);
+  if (last != fLastRequest.end()) {
+    std::chrono::duration<G4double> elapsed = now - last->second.time;
+    fMeasuredTime += elapsed.count();
+    fMeasuredEvents += last->second.nofEvents;
+  }
+
+  G4int remaining = this->numberOfEventToBeProcessed
+                  - this->numberOfEventProcessed;
+  G4int chunk = remaining/(2*std::max(this->GetNumberOfThreads(), 1));
+  if (fMeasuredTime > 0.) {
+    G4double byTime = kChunkTime*fMeasuredEvents/fMeasuredTime;
+    chunk = std::min(chunk, G4int(std::min(byTime, 1.e9)));
+  }
+  else {
+    chunk = 1;
+  }
+  this->eventModulo = std::max(chunk, 1);
+
+  G4int nofEvents = Base::SetUpNEvents(event, seedsQueue, reseedRequired);
+  Request request = { now, nofEvents };
+  fLastRequest[thread] = request;
+  return nofEvents;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+typedef B3ChunkedRunManager<G4MTRunManager> B3MTRunManager;
+
+#endif
+
+#endif
@@ -0,0 +1,66 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3RunState.hh
+/// \brief Definition of the B3RunState class
+
+#ifndef B3RunState_h
+#define B3RunState_h 1
+
+#include "globals.hh"
+
+#include <iosfwd>
+#include <string>
+
+/// Accumulated state of the calling thread: all the registered
+/// accumulables (G4int and G4double G4Accumulable, B3HistoryTally,
+/// B3CountTally) and the bins of all the H1 and H2 histograms.
+///
+/// Save() writes it in binary; Add() adds a saved state to the current
+/// one, so that 0 + a + b is summed in the order of the calls. Used by
+/// the checkpoints and by the ordered merge of the reproducible mode.
+
+class B3RunState
+{
+  public:
+    static void   Save(std::ostream& output);
+    static G4bool Add(std::istream& input);
+    static void   Reset();
+
+    // length-prefixed strings of the state files
+    static void   WriteString(std::ostream& output, const std::string& text);
+    static G4bool ReadString(std::istream& input, std::string& text);
+
+  private:
+    static void   SaveAccumulables(std::ostream& output);
+    static G4bool AddAccumulables(std::istream& input);
+    static void   SaveHistograms(std::ostream& output);
+    static G4bool AddHistograms(std::istream& input);
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,87 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3SpectralCube.hh
+/// \brief Definition of the B3SpectralCube class
+
+#ifndef B3SpectralCube_h
+#define B3SpectralCube_h 1
+
+#include "B3CountTally.hh"
+#include "globals.hh"
+
+class B3SpectralCubeMessenger;
+
+/// Spectral cube of the pixel deposits: counts per (ring, crystal, energy
+/// bin), filled once per pixel and event.
+///
+/// The counts are a B3CountTally, so each thread fills its own flat uint32
+/// array and the master sums them at end of run. The cube is written as a
+/// .npy array of shape (rings, crystals, bins) and type uint32, which
+/// numpy.load(..., mmap_mode='r') maps without parsing; cubes of separate
+/// jobs are summed with the npyMerge program. The deposits above the last
+/// bin are not counted.
+
+class B3SpectralCube
+{
+  public:
+    B3SpectralCube();
+    ~B3SpectralCube();
+
+    void SetEnabled(G4bool flag)      { fEnabled = flag; }
+    void SetNbBins(G4int nbBins)      { fNbBins = nbBins; }
+    void SetMaxEnergy(G4double emax)  { fMaxEnergy = emax; }
+    G4bool IsEnabled() const          { return fEnabled; }
+
+    void BeginOfRun();
+    inline void Fill(G4int pixel, G4double edep);
+
+    void Write(const G4String& fileName) const;
+
+  private:
+    G4bool   fEnabled;
+    G4int    fNbBins;
+    G4double fMaxEnergy;
+    G4int    fNbRings;
+    G4int    fNbCrystals;
+
+    B3CountTally fCounts;
+
+    B3SpectralCubeMessenger* fMessenger;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B3SpectralCube::Fill(G4int pixel, G4double edep)
+{
+  if (!fEnabled) return;
+  G4int bin = G4int(edep/fMaxEnergy*fNbBins);
+  if (bin < fNbBins) fCounts.Count(size_t(pixel)*fNbBins + bin);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
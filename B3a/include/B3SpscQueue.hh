@@ -0,0 +1,77 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3SpscQueue.hh
+/// \brief Definition of the B3SpscQueue class
+
+#ifndef B3SpscQueue_h
+#define B3SpscQueue_h 1
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/// Bounded lock-free queue for one producer thread and one consumer thread.
+///
+/// Push() and Pop() never wait: they return false when the queue is full
+/// or empty. The head index is written only by the consumer and the tail
+/// index only by the producer.
+
+template <typename T>
+class B3SpscQueue
+{
+  public:
+    explicit B3SpscQueue(size_t capacity)
+      : fBuffer(capacity + 1), fHead(0), fTail(0) {}
+
+    bool Push(const T& value)
+    {
+      size_t tail = fTail.load(std::memory_order_relaxed);
+      size_t next = (tail + 1) % fBuffer.size();
+      if (next == fHead.load(std::memory_order_acquire)) return false;
+      fBuffer[tail] = value;
+      fTail.store(next, std::memory_order_release);
+      return true;
+    }
+
+    bool Pop(T& value)
+    {
+      size_t head = fHead.load(std::memory_order_relaxed);
+      if (head == fTail.load(std::memory_order_acquire)) return false;
+      value = fBuffer[head];
+      fHead.store((head + 1) % fBuffer.size(), std::memory_order_release);
+      return true;
+    }
+
+  private:
+    std::vector<T> fBuffer;
+    std::atomic<size_t> fHead;
+    std::atomic<size_t> fTail;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -37,6 +37,7 @@
 ///
 /// One wishes do not track secondary neutrino.Therefore one kills it 
 /// immediately, before created particles will  put in a stack.
+/// Every new track is also tagged with its provenance in B3TrackOrigin.
 
 class B3StackingAction : public G4UserStackingAction
 {
@@ -45,6 +46,7 @@ class B3StackingAction : public G4UserStackingAction
     virtual ~B3StackingAction();
      
     virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track*);        
+    virtual void PrepareNewEvent();
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,133 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3StepProfiler.hh
+/// \brief Definition of the B3StepProfiler class
+
+#ifndef B3StepProfiler_h
+#define B3StepProfiler_h 1
+
+#include "globals.hh"
+#include "G4Threading.hh"
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+class B3StepProfilerMessenger;
+class G4LogicalVolume;
+class G4ParticleDefinition;
+class G4VProcess;
+class G4Step;
+
+/// Profile of the steps by (logical volume, particle, process).
+///
+/// Each thread counts the steps, the tracks (first steps) and a sampled
+/// wall time in its own open-addressing table keyed by the instance IDs of
+/// the volume and the particle and by the type and subtype of the process
+/// that limited the step: no lock and no string in the stepping hot path.
+/// The time of one step in samplingPeriod is measured, from the start of
+/// its track or the end of the previous step action, whichever is last, to
+/// its own step action, and counted samplingPeriod times; the clock is
+/// only read around the sampled steps. At end of run the threads add their
+/// tables, by names, to the shared totals and the master prints the
+/// /B3/profile/nbRows most expensive ones.
+
+class B3StepProfiler
+{
+  public:
+    B3StepProfiler();
+    ~B3StepProfiler();
+
+    void SetEnabled(G4bool flag)       { fEnabled = flag; }
+    void SetSamplingPeriod(G4int period);
+    void SetNbRows(G4int nbRows)       { fNbRows = nbRows; }
+    G4bool IsEnabled() const           { return fEnabled; }
+
+    void BeginOfRun(G4bool master);
+    inline void StartTrack();
+    inline void ProcessStep(const G4Step* step);
+    void EndOfRun(G4bool tracking);
+    void Report() const;
+
+  private:
+    typedef std::chrono::steady_clock Clock;
+    struct Entry {
+      std::uint64_t key;      // 0: empty slot
+      G4long   nofSteps;
+      G4long   nofTracks;
+      G4double time;
+      const G4LogicalVolume*      volume;
+      const G4ParticleDefinition* particle;
+      const G4VProcess*           process;
+    };
+    struct Totals {
+      G4long   nofSteps;
+      G4long   nofTracks;
+      G4double time;
+    };
+
+    void   Count(const G4Step* step);
+    Entry& Find(const G4Step* step);
+    void   Grow();
+
+    G4bool fEnabled;
+    G4int  fSamplingPeriod;
+    G4int  fNbRows;
+
+    std::vector<Entry> fTable;
+    size_t   fNofEntries;
+    G4long   fStepCounter;
+    Clock::time_point fTimingStart;
+
+    // (volume, particle, process) names; added by the threads at end of run
+    static G4Mutex fgMutex;
+    static std::map<std::vector<G4String>, Totals> fgTotals;
+
+    B3StepProfilerMessenger* fMessenger;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B3StepProfiler::StartTrack()
+{
+  // the next step is sampled: it starts here
+  if (fEnabled && (fStepCounter + 1) % fSamplingPeriod == 0) {
+    fTimingStart = Clock::now();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B3StepProfiler::ProcessStep(const G4Step* step)
+{
+  if (fEnabled) Count(step);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,104 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3ThreadTimes.hh
+/// \brief Definition of the B3ThreadTimes class
+
+#ifndef B3ThreadTimes_h
+#define B3ThreadTimes_h 1
+
+#include "globals.hh"
+#include "G4Threading.hh"
+
+#include <chrono>
+#include <vector>
+
+/// Busy and idle time of the tracking threads in a run.
+///
+/// Each thread sums the wall-clock time spent between the begin and the
+/// end of its events, and counts its events and the chunks of consecutive
+/// event IDs it was given. At end of run the threads hand their times to
+/// the master, which reports per thread the busy time, the idle time over
+/// the run (start-up, waiting for events, merge) and the efficiency
+/// sum(busy)/(threads*wall) of the whole run.
+
+class B3ThreadTimes
+{
+  public:
+    B3ThreadTimes();
+    ~B3ThreadTimes();
+
+    void BeginOfRun(G4bool master);
+    inline void BeginOfEvent();
+    inline void EndOfEvent(G4int eventID);
+    void EndOfRun(G4bool tracking);
+    // on the master, after the threads
+    void Report() const;
+
+  private:
+    typedef std::chrono::steady_clock Clock;
+    struct Record {
+      G4int    thread;
+      G4int    nofEvents;
+      G4int    nofChunks;
+      G4double busy;
+      bool operator<(const Record& other) const
+        { return thread < other.thread; }
+    };
+
+    Clock::time_point fEventStart;
+    G4double fBusy;
+    G4int    fNofEvents;
+    G4int    fNofChunks;
+    G4int    fLastEventID;
+
+    // filled by the threads at end of run, reported by the master
+    static G4Mutex fgMutex;
+    static std::vector<Record> fgRecords;
+    static Clock::time_point fgRunStart;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B3ThreadTimes::BeginOfEvent()
+{
+  fEventStart = Clock::now();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void B3ThreadTimes::EndOfEvent(G4int eventID)
+{
+  std::chrono::duration<G4double> elapsed = Clock::now() - fEventStart;
+  fBusy += elapsed.count();
+  ++fNofEvents;
+  if (eventID != fLastEventID + 1) ++fNofChunks;
+  fLastEventID = eventID;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
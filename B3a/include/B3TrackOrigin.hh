@@ -0,0 +1,73 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3TrackOrigin.hh
+/// \brief Definition of the B3TrackOrigin class
+
+#ifndef B3TrackOrigin_h
+#define B3TrackOrigin_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+class G4Track;
+
+/// Provenance flags of the tracks of the current event, indexed by track ID.
+///
+/// Each new track inherits the flags of its parent. A secondary photon that
+/// is not bremsstrahlung (atomic de-excitation) clears kPrimary and sets
+/// kFluorescence with the region where it was emitted. The flags are set by
+/// B3StackingAction and read by B3PixelSD; one instance per thread.
+
+class B3TrackOrigin
+{
+  public:
+    enum Flag {
+      kPrimary      = 1,   // from the primary photon, without re-emission
+      kFluorescence = 2,   // carried by a de-excitation photon
+      kMoSolution   = 4,   // ... emitted in the MoSolution region
+      kPatient      = 8,   // ... emitted in the Patient region
+      kDetector     = 16   // ... emitted in the Detector region
+    };
+
+    static B3TrackOrigin* Instance();
+
+    void Clear() { fFlags.clear(); }
+    void Tag(const G4Track* track);
+
+    G4int GetFlags(G4int trackID) const
+      { return (size_t(trackID) < fFlags.size()) ? fFlags[trackID] : 0; }
+
+  private:
+    B3TrackOrigin();
+
+    std::vector<G4int> fFlags;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
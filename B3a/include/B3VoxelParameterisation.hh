@@ -0,0 +1,75 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3VoxelParameterisation.hh
+/// \brief Definition of the B3VoxelParameterisation class
+
+#ifndef B3VoxelParameterisation_h
+#define B3VoxelParameterisation_h 1
+
+#include "G4PhantomParameterisation.hh"
+#include "G4VVolumeMaterialScanner.hh"
+
+class B3VoxelPhantom;
+
+/// Phantom parameterisation reading the voxel materials from the
+/// memory-mapped indices of B3VoxelPhantom, instead of the size_t per voxel
+/// array of G4PhantomParameterisation.
+///
+/// The material scanner lists the distinct materials of the phantom, so
+/// that the production cuts table does not loop over all the voxels.
+
+class B3VoxelParameterisation : public G4PhantomParameterisation
+{
+  public:
+    B3VoxelParameterisation(const B3VoxelPhantom* phantom);
+    virtual ~B3VoxelParameterisation();
+
+    virtual G4Material* ComputeMaterial(const G4int copyNo,
+                                        G4VPhysicalVolume* currentVol,
+                                        const G4VTouchable* parentTouch = 0);
+
+    virtual G4VVolumeMaterialScanner* GetMaterialScanner()
+      { return &fScanner; }
+
+  private:
+    class MaterialScanner : public G4VVolumeMaterialScanner
+    {
+      public:
+        MaterialScanner(const B3VoxelPhantom* phantom) : fPhantom(phantom) {}
+        virtual G4int GetNumberOfMaterials() const;
+        virtual G4Material* GetMaterial(G4int index) const;
+      private:
+        const B3VoxelPhantom* fPhantom;
+    };
+
+    const B3VoxelPhantom* fPhantom;
+    MaterialScanner fScanner;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
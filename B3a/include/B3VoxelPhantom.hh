@@ -0,0 +1,138 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3VoxelPhantom.hh
+/// \brief Definition of the B3VoxelPhantom class
+
+#ifndef B3VoxelPhantom_h
+#define B3VoxelPhantom_h 1
+
+#include "G4ThreeVector.hh"
+#include "G4Material.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4LogicalVolume;
+class G4VPhysicalVolume;
+class B3VoxelParameterisation;
+
+/// Voxelized patient read from raw files.
+///
+/// The phantom is described by
+/// - an index file: nx*ny*nz uint8 material indices, x running fastest,
+///   then y, then z (the copy number order of G4PhantomParameterisation);
+/// - a material file, with one "index G4_MATERIAL" line per index used in
+///   the index file and optional "Mo level concentration" lines giving the
+///   Mo concentration in mg/cm3 of each level of the Mo map;
+/// - an optional Mo map file: nx*ny*nz uint8 levels (0 = no Mo).
+///
+/// The index and Mo map files are memory-mapped read-only and never copied:
+/// the pages are only read when the navigation enters the voxels, and the
+/// mapping is shared by all the worker threads through the parameterisation.
+/// The material of a voxel is looked up in a (index, level) table holding
+/// one material per combination declared in the material file, so the
+/// number of materials does not grow with the number of voxels.
+///
+/// The voxels are placed in a box container with G4PVParameterised and
+/// navigated with G4RegularNavigation.
+///
+/// The "patient" scorer gives a dose per voxel; the dose of the patient is
+/// their sum weighted by the voxel masses over the phantom mass, computed
+/// once the files are mapped. A uniform dose in every voxel is checked to
+/// give the same patient dose, as with the default single-volume patient.
+
+class B3VoxelPhantom
+{
+  public:
+    B3VoxelPhantom();
+    ~B3VoxelPhantom();
+
+    void SetIndexFile(const G4String& fileName)    { fIndexFile = fileName; }
+    void SetMaterialFile(const G4String& fileName) { fMaterialFile = fileName; }
+    void SetMoMapFile(const G4String& fileName)    { fMoMapFile = fileName; }
+    void SetNbVoxels(G4int nx, G4int ny, G4int nz);
+    void SetVoxelSize(const G4ThreeVector& size)   { fVoxelSize = size; }
+
+    // the phantom replaces the default patient once an index file is given
+    G4bool IsDefined() const { return !fIndexFile.empty(); }
+
+    G4int GetNbVoxels(G4int axis) const { return fNbVoxels[axis]; }
+    G4int GetNbVoxels() const 
+      { return fNbVoxels[0]*fNbVoxels[1]*fNbVoxels[2]; }
+    const G4ThreeVector& GetVoxelSize() const { return fVoxelSize; }
+    G4ThreeVector GetHalfSize() const;
+
+    // map the files, build the materials and place the phantom container
+    // in the mother volume; returns the container logical volume
+    G4LogicalVolume* Construct(G4LogicalVolume* motherLV);
+    G4LogicalVolume* GetVoxelVolume() const { return fVoxelLV; }
+
+    G4Material* GetVoxelMaterial(size_t copyNo) const
+    {
+      size_t level = fMoMap ? fMoMap[copyNo] : 0;
+      return fMaterialTable[(size_t(fIndex[copyNo]) << 8) | level];
+    }
+    const std::vector<G4Material*>& GetMaterials() const { return fMaterials; }
+
+    // voxel mass, and the part of the patient dose of a voxel dose
+    G4double GetVoxelMass(size_t copyNo) const
+    {
+      return fVoxelSize.x()*fVoxelSize.y()*fVoxelSize.z()
+             *GetVoxelMaterial(copyNo)->GetDensity();
+    }
+    G4double GetMass() const { return fMass; }
+    G4double GetPatientDose(size_t copyNo, G4double voxelDose) const
+      { return voxelDose*GetVoxelMass(copyNo)/fMass; }
+
+  private:
+    void Load();
+    void PlaceVoxels(G4VPhysicalVolume* physPatient);
+    void ReadMaterialFile();
+    void ComputeMass();
+    void UnmapFiles();
+
+    G4String fIndexFile;
+    G4String fMaterialFile;
+    G4String fMoMapFile;
+    G4int    fNbVoxels[3];
+    G4ThreeVector fVoxelSize;
+
+    const unsigned char* fIndex;
+    const unsigned char* fMoMap;
+    size_t   fMappedSize;
+
+    std::vector<G4Material*> fMaterialTable;   // (index << 8 | level)
+    std::vector<G4Material*> fMaterials;       // distinct materials
+    G4double fMass;
+
+    G4LogicalVolume* fVoxelLV;
+    B3VoxelParameterisation* fParameterisation;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -31,21 +31,27 @@
 #define B3aActionInitialization_h 1
 
 #include "G4VUserActionInitialization.hh"
+#include "globals.hh"
 
 /// Action initialization class.
 ///
+/// The output file name given on the command line is passed
+/// to the run actions of master and workers.
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 class B3aActionInitialization : public G4VUserActionInitialization
 {
   public:
-    B3aActionInitialization();
+    B3aActionInitialization(const G4String& outputName = "Test");
     virtual ~B3aActionInitialization();
 
     virtual void BuildForMaster() const;
     virtual void Build() const;
 
+  private:
+    G4String fOutputName;
+
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -34,12 +34,14 @@
 #include "globals.hh"
 
 class B3aRunAction;
+class B3PixelSD;
+class B3VoxelPhantom;
 
 /// Event action class
 ///
 /// In EndOfEventAction() there is collected information event per event 
-/// from Hits Collections, and accumulated statistic for 
-/// B3RunAction::EndOfRunAction().
+/// from the pixel detector and from Hits Collections, and accumulated
+/// statistic for B3RunAction::EndOfRunAction().
 
 class B3aEventAction : public G4UserEventAction
 {
@@ -52,7 +54,8 @@ class B3aEventAction : public G4UserEventAction
     
   private:
     B3aRunAction*  fRunAction;
-    G4int fCollID_cryst;
+    B3PixelSD*     fPixelSD;
+    const B3VoxelPhantom* fPhantom;
     G4int fCollID_patient;   
 };
 
@@ -34,12 +34,27 @@
 #include "G4Accumulable.hh"
 #include "globals.hh"
 
+class B3ForcedDetection;
+class B3DoseGrid;
+class B3ListMode;
+class B3SpectralCube;
+class B3Checkpoint;
+class B3Reproducibility;
+class B3ThreadTimes;
+class B3StepProfiler;
+class B3AutoStop;
+class B3PhaseSpace;
+class B3ResponseBuilder;
+
 /// Run action class
+///
+/// It holds the accumulated statistics of the run and the optional
+/// scorers, which are merged on the master and written at end of run.
 
 class B3aRunAction : public G4UserRunAction
 {
   public:
-    B3aRunAction();
+    B3aRunAction(const G4String& outputName = "Test");
     virtual ~B3aRunAction();
     
     virtual void BeginOfRunAction(const G4Run*);
@@ -48,9 +63,37 @@ class B3aRunAction : public G4UserRunAction
     void CountEvent()           { fGoodEvents += 1; };
     void SumDose(G4double dose) { fSumDose += dose; };  
 
+    B3ForcedDetection* GetForcedDetection() const { return fForcedDetection; }
+    B3DoseGrid*        GetDoseGrid()        const { return fDoseGrid; }
+    B3ListMode*        GetListMode()        const { return fListMode; }
+    B3SpectralCube*    GetSpectralCube()    const { return fSpectralCube; }
+    B3Checkpoint*      GetCheckpoint()      const { return fCheckpoint; }
+    B3Reproducibility* GetReproducibility() const { return fReproducibility; }
+    B3ThreadTimes*     GetThreadTimes()     const { return fThreadTimes; }
+    B3StepProfiler*    GetStepProfiler()    const { return fStepProfiler; }
+    B3AutoStop*        GetAutoStop()        const { return fAutoStop; }
+    B3PhaseSpace*      GetPhaseSpace()      const { return fPhaseSpace; }
+    B3ResponseBuilder* GetResponseBuilder() const { return fResponseBuilder; }
+
 private:
+    void WriteHistograms() const;
+
+    G4String                fOutputName;
+    G4String                fRunName;
     G4Accumulable<G4int>    fGoodEvents;
     G4Accumulable<G4double> fSumDose;  
+
+    B3ForcedDetection*      fForcedDetection;
+    B3DoseGrid*             fDoseGrid;
+    B3ListMode*             fListMode;
+    B3SpectralCube*         fSpectralCube;
+    B3Checkpoint*           fCheckpoint;
+    B3Reproducibility*      fReproducibility;
+    B3ThreadTimes*          fThreadTimes;
+    B3StepProfiler*         fStepProfiler;
+    B3AutoStop*             fAutoStop;
+    B3PhaseSpace*           fPhaseSpace;
+    B3ResponseBuilder*      fResponseBuilder;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -24,14 +24,33 @@
 // ********************************************************************
 //
 //
-/// \file MyAnalysis.hh
-/// \brief Selection of the analysis technology
+/// \file B3aSteppingAction.hh
+/// \brief Definition of the B3aSteppingAction class
 
-#ifndef MyAnalysis_h
-#define MyAnalysis_h 1
+#ifndef B3aSteppingAction_h
+#define B3aSteppingAction_h 1
 
-//#include "g4root.hh"
-#include "g4csv.hh"
-//#include "g4xml.hh"
+#include "G4UserSteppingAction.hh"
+#include "globals.hh"
+
+class B3aRunAction;
+
+/// Stepping action class
+///
+/// It passes the steps to the optional scorers held by the run action.
+
+class B3aSteppingAction : public G4UserSteppingAction
+{
+  public:
+    B3aSteppingAction(B3aRunAction* runAction);
+    virtual ~B3aSteppingAction();
+
+    virtual void UserSteppingAction(const G4Step*);
+
+  private:
+    B3aRunAction* fRunAction;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 #endif
@@ -0,0 +1,81 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file npyMerge.cc
+/// \brief Merge of .npy arrays written by separate jobs
+
+#include "B3NpyMerge.hh"
+
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  void PrintUsage() {
+    G4cerr << " Usage: " << G4endl;
+    G4cerr << " npyMerge [--events n1,n2,...] output.npy input1.npy"
+           << " input2.npy ..." << G4endl;
+    G4cerr << "   sums arrays of the same shape and type (<u4, <i4 or <f8):"
+           << G4endl;
+    G4cerr << "   spectral cubes, histograms" << G4endl;
+    G4cerr << "   --events : averages arrays of mean and error planes"
+           << " (dose grid, forced detection)," << G4endl;
+    G4cerr << "              weighted by the events of each input" << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc,char** argv)
+{
+  G4int first = 1;
+  std::vector<G4double> nofEvents;
+  if ( argc > 2 && G4String(argv[1]) == "--events" ) {
+    G4String list = argv[2];
+    for (size_t i = 0; i < list.size(); ++i) if (list[i] == ',') list[i] = ' ';
+    std::istringstream is(list);
+    G4double n;
+    while (is >> n) nofEvents.push_back(n);
+    first = 3;
+  }
+  if ( argc < first + 2 ) {
+    PrintUsage();
+    return 1;
+  }
+
+  G4String output = argv[first];
+  std::vector<G4String> inputs(argv + first + 1, argv + argc);
+  G4bool ok = nofEvents.empty() ? B3NpyMerge::Sum(output, inputs)
+            : B3NpyMerge::Average(output, inputs, nofEvents);
+  if ( ! ok ) return 1;
+
+  G4cout << "npyMerge: " << inputs.size() << " files "
+         << (nofEvents.empty() ? "summed" : "averaged") << " into " << output
+         << G4endl;
+  return 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,246 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3AutoStop.cc
+/// \brief Implementation of the B3AutoStop class
+
+#include "B3AutoStop.hh"
+#include "B3AutoStopMessenger.hh"
+#include "B3Checkpoint.hh"
+
+#include "G4RunManager.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+  const char* const kNames[B3AutoStop::kNofObservables]
+    = { "goodEvents", "dose", "window" };
+
+  // atomic addition of a double, lock-free
+  void Add(std::atomic<G4double>& total, G4double value)
+  {
+    G4double old = total.load(std::memory_order_relaxed);
+    while (!total.compare_exchange_weak(old, old + value,
+                                        std::memory_order_relaxed)) {}
+  }
+}
+
+std::atomic<G4double> B3AutoStop::fgSum[B3AutoStop::kNofObservables];
+std::atomic<G4double> B3AutoStop::fgSum2[B3AutoStop::kNofObservables];
+std::atomic<G4long>   B3AutoStop::fgNofEvents(0);
+std::atomic<G4int>    B3AutoStop::fgReason(B3AutoStop::kNone);
+B3AutoStop::Clock::time_point B3AutoStop::fgRunStart;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3AutoStop::B3AutoStop()
+ : fEnabled(false),
+   fPrecision(0.01),
+   fTimeLimit(0.),
+   fWindowMin(17.0*keV),
+   fWindowMax(18.0*keV),
+   fCheckInterval(1000),
+   fNofEvents(0),
+   fMessenger(0)
+{
+  for (G4int i = 0; i < kNofObservables; ++i) {
+    fSelected[i] = true;
+    fHistory[i] = fSum[i] = fSum2[i] = 0.;
+  }
+  fMessenger = new B3AutoStopMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3AutoStop::~B3AutoStop()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3AutoStop::SetWindow(G4double emin, G4double emax)
+{
+  fWindowMin = emin;
+  fWindowMax = emax;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3AutoStop::SetObservables(const G4String& names)
+{
+  G4bool selected[kNofObservables] = { false, false, false };
+  std::istringstream input(names);
+  G4String name;
+  while (input >> name) {
+    G4int i = 0;
+    while (i < kNofObservables && name != kNames[i]) ++i;
+    if (i == kNofObservables) {
+      G4ExceptionDescription msg;
+      msg << "Unknown observable " << name
+          << "; expected goodEvents, dose or window." << G4endl
+          << "The observables are not changed.";
+      G4Exception("B3AutoStop::SetObservables()", "MyCode0009",
+                  JustWarning, msg);
+      return;
+    }
+    selected[i] = true;
+  }
+  for (G4int i = 0; i < kNofObservables; ++i) fSelected[i] = selected[i];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3AutoStop::BeginOfRun(G4bool master)
+{
+  for (G4int i = 0; i < kNofObservables; ++i) {
+    fHistory[i] = fSum[i] = fSum2[i] = 0.;
+  }
+  fNofEvents = 0;
+  if (master) {
+    for (G4int i = 0; i < kNofObservables; ++i) {
+      fgSum[i] = 0.;
+      fgSum2[i] = 0.;
+    }
+    fgNofEvents = 0;
+    fgReason = kNone;
+    fgRunStart = Clock::now();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3AutoStop::EndOfEvent(G4int eventID)
+{
+  if (!fEnabled) return;
+
+  if (!B3Checkpoint::IsDone(eventID)) {
+    for (G4int i = 0; i < kNofObservables; ++i) {
+      fSum[i]  += fHistory[i];
+      fSum2[i] += fHistory[i]*fHistory[i];
+      fHistory[i] = 0.;
+    }
+    if (++fNofEvents >= fCheckInterval) {
+      Publish();
+      // the first thread to stop the run gives the reason
+      G4int none = kNone;
+      if (fgReason.load(std::memory_order_relaxed) == kNone) {
+        fgReason.compare_exchange_strong(none, Check());
+      }
+    }
+  }
+
+  // each thread stops its own event loop, after this event
+  if (fgReason.load(std::memory_order_relaxed) != kNone) {
+    G4RunManager::GetRunManager()->AbortRun(true);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3AutoStop::Publish()
+{
+  for (G4int i = 0; i < kNofObservables; ++i) {
+    Add(fgSum[i], fSum[i]);
+    Add(fgSum2[i], fSum2[i]);
+    fSum[i] = fSum2[i] = 0.;
+  }
+  fgNofEvents.fetch_add(fNofEvents, std::memory_order_relaxed);
+  fNofEvents = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int B3AutoStop::Check() const
+{
+  if (fTimeLimit > 0. &&
+      std::chrono::duration<G4double>(Clock::now() - fgRunStart).count()
+        >= fTimeLimit/s) return kTimeLimit;
+
+  // with no observable selected, only the time limit stops the run
+  G4bool any = false;
+  for (G4int i = 0; i < kNofObservables; ++i) {
+    if (!fSelected[i]) continue;
+    if (!(RelativeError(i) <= fPrecision)) return kNone;
+    any = true;
+  }
+  return any ? kPrecision : kNone;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B3AutoStop::RelativeError(G4int observable)
+{
+  // relative standard error of the mean per history;
+  // infinite before two histories and while nothing is scored
+  G4double n = fgNofEvents.load(std::memory_order_relaxed);
+  G4double sum  = fgSum[observable].load(std::memory_order_relaxed);
+  G4double sum2 = fgSum2[observable].load(std::memory_order_relaxed);
+  if (n < 2. || sum <= 0.) return HUGE_VAL;
+  G4double variance = std::max(sum2 - sum*sum/n, 0.)/(n*(n - 1.));
+  return std::sqrt(variance)*n/sum;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3AutoStop::EndOfRun(G4bool tracking)
+{
+  // the remaining histories, for the report
+  if (fEnabled && tracking) Publish();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3AutoStop::Report() const
+{
+  if (!fEnabled) return;
+
+  G4int reason = fgReason.load();
+  std::ios::fmtflags flags = G4cout.flags();
+  std::streamsize precision = G4cout.precision(4);
+  G4cout << G4endl << " Automatic stop: "
+         << (reason == kPrecision ? "target precision reached"
+             : reason == kTimeLimit ? "time limit reached"
+             : "all the events done")
+         << " after " << fgNofEvents.load() << " events" << G4endl;
+  for (G4int i = 0; i < kNofObservables; ++i) {
+    G4double error = RelativeError(i);
+    G4cout << "  " << std::left << std::setw(12) << kNames[i] << std::right
+           << " relative error ";
+    if (error < HUGE_VAL) G4cout << error;
+    else                  G4cout << "-";
+    if (fSelected[i]) G4cout << " (target " << fPrecision << ")";
+    G4cout << G4endl;
+  }
+  G4cout.flags(flags);
+  G4cout.precision(precision);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
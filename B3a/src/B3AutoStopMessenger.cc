@@ -0,0 +1,153 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3AutoStopMessenger.cc
+/// \brief Implementation of the B3AutoStopMessenger class
+
+#include "B3AutoStopMessenger.hh"
+#include "B3AutoStop.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3AutoStopMessenger::B3AutoStopMessenger(B3AutoStop* autoStop)
+ : G4UImessenger(),
+   fAutoStop(autoStop),
+   fDirectory(0),
+   fEnableCmd(0),
+   fPrecisionCmd(0),
+   fTimeLimitCmd(0),
+   fWindowCmd(0),
+   fObservablesCmd(0),
+   fCheckIntervalCmd(0)
+{
+  fDirectory = new G4UIdirectory("/B3/autoStop/");
+  fDirectory->SetGuidance("Stop of the run on its statistical uncertainty.");
+
+  fEnableCmd = new G4UIcmdWithABool("/B3/autoStop/enable",this);
+  fEnableCmd->SetGuidance("Stop the run when the observables reach the");
+  fEnableCmd->SetGuidance("target precision or when the time limit is over.");
+  fEnableCmd->SetParameterName("flag",true);
+  fEnableCmd->SetDefaultValue(true);
+  fEnableCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fPrecisionCmd = new G4UIcmdWithADouble("/B3/autoStop/precision",this);
+  fPrecisionCmd->SetGuidance("Target relative standard error of the mean");
+  fPrecisionCmd->SetGuidance("per event of each selected observable.");
+  fPrecisionCmd->SetParameterName("precision",false);
+  fPrecisionCmd->SetRange("precision>0.");
+  fPrecisionCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fTimeLimitCmd = new G4UIcmdWithADoubleAndUnit("/B3/autoStop/timeLimit",this);
+  fTimeLimitCmd->SetGuidance("Wall time limit of the run; 0 for none.");
+  fTimeLimitCmd->SetParameterName("limit",false);
+  fTimeLimitCmd->SetRange("limit>=0.");
+  fTimeLimitCmd->SetUnitCategory("Time");
+  fTimeLimitCmd->SetDefaultUnit("s");
+  fTimeLimitCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fWindowCmd = new G4UIcommand("/B3/autoStop/window",this);
+  fWindowCmd->SetGuidance("Energy window of the counted pixel deposits.");
+  G4UIparameter* param = new G4UIparameter("emin",'d',false);
+  param->SetParameterRange("emin>=0.");
+  fWindowCmd->SetParameter(param);
+  param = new G4UIparameter("emax",'d',false);
+  param->SetParameterRange("emax>0.");
+  fWindowCmd->SetParameter(param);
+  param = new G4UIparameter("unit",'s',true);
+  param->SetDefaultValue("keV");
+  fWindowCmd->SetParameter(param);
+  fWindowCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fObservablesCmd = new G4UIcmdWithAString("/B3/autoStop/observables",this);
+  fObservablesCmd->SetGuidance("Observables that must reach the precision,");
+  fObservablesCmd->SetGuidance("among goodEvents, dose and window.");
+  fObservablesCmd->SetParameterName("names",false);
+  fObservablesCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fCheckIntervalCmd =
+    new G4UIcmdWithAnInteger("/B3/autoStop/checkInterval",this);
+  fCheckIntervalCmd->SetGuidance("Number of events of a thread between two");
+  fCheckIntervalCmd->SetGuidance("updates of the totals and checks.");
+  fCheckIntervalCmd->SetParameterName("nbEvents",false);
+  fCheckIntervalCmd->SetRange("nbEvents>0");
+  fCheckIntervalCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3AutoStopMessenger::~B3AutoStopMessenger()
+{
+  delete fEnableCmd;
+  delete fPrecisionCmd;
+  delete fTimeLimitCmd;
+  delete fWindowCmd;
+  delete fObservablesCmd;
+  delete fCheckIntervalCmd;
+  delete fDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3AutoStopMessenger::SetNewValue(G4UIcommand* command,
+                                      G4String newValue)
+{
+  if ( command == fEnableCmd ) {
+    fAutoStop->SetEnabled(fEnableCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fPrecisionCmd ) {
+    fAutoStop->SetPrecision(fPrecisionCmd->GetNewDoubleValue(newValue));
+  }
+  else if ( command == fTimeLimitCmd ) {
+    fAutoStop->SetTimeLimit(fTimeLimitCmd->GetNewDoubleValue(newValue));
+  }
+  else if ( command == fWindowCmd ) {
+    G4double emin, emax;
+    G4String unit;
+    std::istringstream input(newValue);
+    input >> emin >> emax >> unit;
+    G4double value = G4UIcommand::ValueOf(unit);
+    fAutoStop->SetWindow(emin*value, emax*value);
+  }
+  else if ( command == fObservablesCmd ) {
+    fAutoStop->SetObservables(newValue);
+  }
+  else if ( command == fCheckIntervalCmd ) {
+    fAutoStop->SetCheckInterval(fCheckIntervalCmd->GetNewIntValue(newValue));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
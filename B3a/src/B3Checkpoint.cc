@@ -0,0 +1,291 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3Checkpoint.cc
+/// \brief Implementation of the B3Checkpoint class
+
+#include "B3Checkpoint.hh"
+#include "B3CheckpointMessenger.hh"
+#include "B3RunState.hh"
+
+#include "G4Threading.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include <dirent.h>
+
+namespace
+{
+  const char  kMagic[4] = { 'B', '3', 'C', 'K' };
+  const G4int kVersion  = 2;
+}
+
+std::vector<char> B3Checkpoint::fgDone;
+G4int B3Checkpoint::fgGeneration = 0;
+G4int B3Checkpoint::fgNofEvents = 0;
+G4long B3Checkpoint::fgSeed = 0;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3Checkpoint::B3Checkpoint()
+ : fEnabled(false),
+   fInterval(300.*s),
+   fMessenger(0)
+{
+  fMessenger = new B3CheckpointMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3Checkpoint::~B3Checkpoint()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3Checkpoint::BeginOfRun(const G4String& runName, G4int nofEvents,
+                              G4bool master, G4bool tracking, G4bool listMode)
+{
+  fRunName = runName;
+  fFileName = "";
+  fEvents.clear();
+  fSuperseded.clear();
+  if (!fEnabled) return;
+
+  G4bool sequential = master && tracking;
+  if (master) {
+    fgDone.clear();
+    fgGeneration = 0;
+    // the seed set before the run, by /random/setSeed
+    fgNofEvents = nofEvents;
+    fgSeed = G4Random::getTheSeed();
+    std::vector<File> files = FindFiles();
+    std::sort(files.begin(), files.end());
+    // the list-mode files are written again from the start of the run:
+    // the records of the restored events would be lost
+    if (files.size() && listMode) {
+      G4ExceptionDescription msg;
+      msg << "Cannot resume " << fRunName << " from its checkpoints with"
+          << " the list mode on: the records of the restored events are"
+          << " not in them. Disable /B3/listMode/enable, or remove the"
+          << " checkpoint files to start the run again.";
+      G4Exception("B3Checkpoint::BeginOfRun()", "MyCode0007",
+                  FatalException, msg);
+    }
+    for (size_t i = 0; i < files.size(); ++i) {
+      if (!Restore(files[i].name, sequential)) {
+        G4ExceptionDescription msg;
+        msg << "Cannot restore the checkpoint " << files[i].name
+            << ", written by another configuration of the run?";
+        G4Exception("B3Checkpoint::BeginOfRun()", "MyCode0007",
+                    FatalException, msg);
+      }
+      fgGeneration = std::max(fgGeneration, files[i].generation + 1);
+      // a sequential run saves everything again in the next generation
+      if (sequential) fSuperseded.push_back(files[i].name);
+    }
+    G4int nofDone = std::count(fgDone.begin(), fgDone.end(), 1);
+    if (files.size()) {
+      G4cout << " Checkpoint: " << nofDone << " events restored from "
+             << files.size() << " files of " << fRunName << G4endl;
+    }
+    if (sequential) {
+      for (size_t id = 0; id < fgDone.size(); ++id) {
+        if (fgDone[id]) fEvents.push_back(id);
+      }
+    }
+  }
+
+  if (!tracking) return;
+  std::ostringstream fileName;
+  fileName << fRunName << "_ckpt_g" << fgGeneration << "_t"
+           << std::max(G4Threading::G4GetThreadId(), 0) << ".bin";
+  fFileName = fileName.str();
+  fLastWrite = std::chrono::steady_clock::now();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3Checkpoint::EndOfEvent(G4int eventID)
+{
+  if (fFileName.empty() || IsDone(eventID)) return;
+  fEvents.push_back(eventID);
+
+  std::chrono::duration<G4double> elapsed =
+    std::chrono::steady_clock::now() - fLastWrite;
+  if (elapsed.count()*s < fInterval) return;
+
+  Write();
+  fLastWrite = std::chrono::steady_clock::now();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3Checkpoint::EndOfRun(G4bool master)
+{
+  // the run is complete: its checkpoints are of no use any more
+  if (!fEnabled || !master) return;
+  std::vector<File> files = FindFiles();
+  for (size_t i = 0; i < files.size(); ++i) {
+    std::remove(files[i].name.c_str());
+  }
+  fgDone.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<B3Checkpoint::File> B3Checkpoint::FindFiles() const
+{
+  // <directory>/<base>_ckpt_g<generation>_t<thread>.bin
+  G4String directory = ".";
+  G4String base = fRunName;
+  size_t slash = fRunName.rfind('/');
+  if (slash != std::string::npos) {
+    directory = fRunName.substr(0, slash + 1);
+    base = fRunName.substr(slash + 1);
+  }
+  G4String prefix = base + "_ckpt_g";
+
+  std::vector<File> files;
+  DIR* dir = opendir(directory.c_str());
+  if (!dir) return files;
+  while (dirent* entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.compare(0, prefix.size(), prefix) != 0) continue;
+    if (name.size() < 4 || name.compare(name.size() - 4, 4, ".bin") != 0) {
+      continue;
+    }
+    File file;
+    file.generation = std::atoi(name.c_str() + prefix.size());
+    file.name = (slash != std::string::npos) ? directory + name : name;
+    files.push_back(file);
+  }
+  closedir(dir);
+  return files;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3Checkpoint::Write()
+{
+  G4String tmpName = fFileName + ".tmp";
+  std::ofstream output(tmpName, std::ios::binary);
+
+  output.write(kMagic, 4);
+  output.write(reinterpret_cast<const char*>(&kVersion), sizeof(kVersion));
+  output.write(reinterpret_cast<const char*>(&fgNofEvents),
+               sizeof(fgNofEvents));
+  output.write(reinterpret_cast<const char*>(&fgSeed), sizeof(fgSeed));
+  G4long nofEvents = fEvents.size();
+  output.write(reinterpret_cast<const char*>(&nofEvents), sizeof(nofEvents));
+  if (nofEvents) output.write(reinterpret_cast<const char*>(&fEvents[0]),
+                              nofEvents*sizeof(G4int));
+
+  // the engine matters only when one thread runs all the events
+  std::ostringstream engine;
+  if (!G4Threading::IsMultithreadedApplication()) {
+    G4Random::saveFullState(engine);
+  }
+  B3RunState::WriteString(output, engine.str());
+
+  B3RunState::Save(output);
+  output.close();
+
+  if (!output || std::rename(tmpName.c_str(), fFileName.c_str()) != 0) {
+    G4ExceptionDescription msg;
+    msg << "Cannot write the checkpoint " << fFileName;
+    G4Exception("B3Checkpoint::Write()", "MyCode0007", JustWarning, msg);
+    return;
+  }
+
+  for (size_t i = 0; i < fSuperseded.size(); ++i) {
+    if (fSuperseded[i] != fFileName) std::remove(fSuperseded[i].c_str());
+  }
+  fSuperseded.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3Checkpoint::Restore(const G4String& fileName, G4bool sequential)
+{
+  std::ifstream input(fileName, std::ios::binary);
+  char magic[4];
+  G4int version = 0;
+  if (!input.read(magic, 4) || !std::equal(magic, magic + 4, kMagic) ||
+      !input.read(reinterpret_cast<char*>(&version), sizeof(version)) ||
+      version != kVersion) return false;
+
+  // the events restored are normalised to the events of the run
+  G4int nofEventsOfRun = 0;
+  G4long seed = 0;
+  if (!input.read(reinterpret_cast<char*>(&nofEventsOfRun),
+                  sizeof(nofEventsOfRun)) ||
+      !input.read(reinterpret_cast<char*>(&seed), sizeof(seed))) {
+    return false;
+  }
+  if (nofEventsOfRun != fgNofEvents || seed != fgSeed) {
+    G4ExceptionDescription msg;
+    msg << "The checkpoint " << fileName << " is of a run of "
+        << nofEventsOfRun << " events with seed " << seed << ", not "
+        << fgNofEvents << " events with seed " << fgSeed << ". Start the"
+        << " run with the same /run/beamOn and seed, or remove the"
+        << " checkpoint files to start it again.";
+    G4Exception("B3Checkpoint::Restore()", "MyCode0007",
+                FatalException, msg);
+    return false;
+  }
+
+  G4long nofEvents = 0;
+  if (!input.read(reinterpret_cast<char*>(&nofEvents), sizeof(nofEvents))) {
+    return false;
+  }
+  std::vector<G4int> events(nofEvents);
+  if (nofEvents &&
+      !input.read(reinterpret_cast<char*>(&events[0]),
+                  nofEvents*sizeof(G4int))) return false;
+  for (size_t i = 0; i < events.size(); ++i) {
+    if (size_t(events[i]) >= fgDone.size()) fgDone.resize(events[i] + 1, 0);
+    fgDone[events[i]] = 1;
+  }
+
+  std::string engine;
+  if (!B3RunState::ReadString(input, engine)) return false;
+  if (sequential && engine.size()) {
+    std::istringstream is(engine);
+    G4Random::restoreFullState(is);
+  }
+
+  return B3RunState::Add(input);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
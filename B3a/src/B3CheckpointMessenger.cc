@@ -0,0 +1,88 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3CheckpointMessenger.cc
+/// \brief Implementation of the B3CheckpointMessenger class
+
+#include "B3CheckpointMessenger.hh"
+#include "B3Checkpoint.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3CheckpointMessenger::B3CheckpointMessenger(B3Checkpoint* checkpoint)
+ : G4UImessenger(),
+   fCheckpoint(checkpoint),
+   fDirectory(0),
+   fEnableCmd(0),
+   fIntervalCmd(0)
+{
+  fDirectory = new G4UIdirectory("/B3/checkpoint/");
+  fDirectory->SetGuidance("Checkpoint and resume of long runs.");
+
+  fEnableCmd = new G4UIcmdWithABool("/B3/checkpoint/enable",this);
+  fEnableCmd->SetGuidance("Write checkpoints during the runs, and resume");
+  fEnableCmd->SetGuidance("a run from the checkpoints found at its start.");
+  fEnableCmd->SetParameterName("flag",true);
+  fEnableCmd->SetDefaultValue(true);
+  fEnableCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fIntervalCmd = new G4UIcmdWithADoubleAndUnit("/B3/checkpoint/interval",this);
+  fIntervalCmd->SetGuidance("Minimum wall-clock time between two checkpoints");
+  fIntervalCmd->SetGuidance("of a thread.");
+  fIntervalCmd->SetParameterName("interval",false);
+  fIntervalCmd->SetRange("interval>=0.");
+  fIntervalCmd->SetUnitCategory("Time");
+  fIntervalCmd->SetDefaultUnit("s");
+  fIntervalCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3CheckpointMessenger::~B3CheckpointMessenger()
+{
+  delete fEnableCmd;
+  delete fIntervalCmd;
+  delete fDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3CheckpointMessenger::SetNewValue(G4UIcommand* command,
+                                        G4String newValue)
+{
+  if ( command == fEnableCmd ) {
+    fCheckpoint->SetEnabled(fEnableCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fIntervalCmd ) {
+    fCheckpoint->SetInterval(fIntervalCmd->GetNewDoubleValue(newValue));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
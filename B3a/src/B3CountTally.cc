@@ -0,0 +1,101 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3CountTally.cc
+/// \brief Implementation of the B3CountTally class
+
+#include "B3CountTally.hh"
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3CountTally::B3CountTally(const G4String& name)
+ : G4VAccumulable(name),
+   fCounts()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3CountTally::~B3CountTally()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3CountTally::SetSize(size_t size)
+{
+  if (size != fCounts.size()) fCounts.assign(size, 0);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3CountTally::Merge(const G4VAccumulable& other)
+{
+  const B3CountTally& tally = static_cast<const B3CountTally&>(other);
+  if (tally.fCounts.empty()) return;
+
+  if (fCounts.size() != tally.fCounts.size()) SetSize(tally.fCounts.size());
+  for (size_t i = 0; i < fCounts.size(); ++i) fCounts[i] += tally.fCounts[i];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3CountTally::Reset()
+{
+  std::fill(fCounts.begin(), fCounts.end(), 0);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3CountTally::Save(std::ostream& output) const
+{
+  G4long size = fCounts.size();
+  output.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  if (size == 0) return;
+  output.write(reinterpret_cast<const char*>(&fCounts[0]),
+               size*sizeof(unsigned int));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3CountTally::Restore(std::istream& input)
+{
+  G4long size = 0;
+  if (!input.read(reinterpret_cast<char*>(&size), sizeof(size))) return false;
+  if (size == 0) return true;
+  if (fCounts.empty()) SetSize(size);
+  if (size_t(size) != fCounts.size()) return false;
+
+  std::vector<unsigned int> counts(size);
+  input.read(reinterpret_cast<char*>(&counts[0]), size*sizeof(unsigned int));
+  if (!input) return false;
+  for (size_t i = 0; i < fCounts.size(); ++i) fCounts[i] += counts[i];
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,99 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3CrystalParameterisation.cc
+/// \brief Implementation of the B3CrystalParameterisation class
+
+#include "B3CrystalParameterisation.hh"
+#include "B3DetectorConstruction.hh"
+
+#include "G4VPhysicalVolume.hh"
+#include "G4VTouchable.hh"
+#include "G4Material.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cmath>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3CrystalParameterisation::B3CrystalParameterisation(
+                             const B3DetectorConstruction* detector,
+                             G4Material* crystalMaterial,
+                             G4Material* holeMaterial)
+ : G4VPVParameterisation(),
+   fDetector(detector),
+   fCrystalMaterial(crystalMaterial),
+   fHoleMaterial(holeMaterial)
+{
+  G4int nbCrystals = detector->GetNbCrystals();
+  G4double radius
+    = detector->GetRingInnerRadius() + 0.5*detector->GetCrystalDZ();
+  G4double dPhi = twopi/nbCrystals;
+  fRotations.resize(nbCrystals);
+  fPositions.resize(nbCrystals);
+  for (G4int icrys = 0; icrys < nbCrystals; ++icrys) {
+    G4double phi = icrys*dPhi;
+    G4RotationMatrix rotm;
+    rotm.rotateY(90*deg);
+    rotm.rotateZ(phi);
+    // the volume takes the inverse of the rotation of a G4Transform3D
+    fRotations[icrys] = rotm.inverse();
+    fPositions[icrys] = radius*G4ThreeVector(std::cos(phi), std::sin(phi), 0.);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3CrystalParameterisation::~B3CrystalParameterisation()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3CrystalParameterisation::ComputeTransformation(
+                                  const G4int copyNo,
+                                  G4VPhysicalVolume* physVol) const
+{
+  physVol->SetRotation(const_cast<G4RotationMatrix*>(&fRotations[copyNo]));
+  physVol->SetTranslation(fPositions[copyNo]);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4Material* B3CrystalParameterisation::ComputeMaterial(
+                                         const G4int copyNo,
+                                         G4VPhysicalVolume*,
+                                         const G4VTouchable* parentTouch)
+{
+  // without a touchable (material scan of the region), any crystal
+  if (parentTouch &&
+      fDetector->IsBeamHole(parentTouch->GetReplicaNumber(0), copyNo)) {
+    return fHoleMaterial;
+  }
+  return fCrystalMaterial;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -28,61 +28,184 @@
 /// \brief Implementation of the B3DetectorConstruction class
 
 #include "B3DetectorConstruction.hh"
+#include "B3DetectorMessenger.hh"
+#include "B3PixelSD.hh"
+#include "B3VoxelPhantom.hh"
+#include "B3CrystalParameterisation.hh"
+#include "B3OverlapCheck.hh"
+#include "B3GeometrySnapshot.hh"
+#include "B3ResponseLibrary.hh"
+#include "B3ResponseModel.hh"
 
 #include "G4NistManager.hh"
 #include "G4Box.hh"
 #include "G4Tubs.hh"
 #include "G4LogicalVolume.hh"
 #include "G4PVPlacement.hh"
-#include "G4RotationMatrix.hh"
-#include "G4Transform3D.hh"
+#include "G4PVReplica.hh"
+#include "G4PVParameterised.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4GeometryManager.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4SolidStore.hh"
+#include "G4FastSimulationManager.hh"
+#include "G4FastSimulationPhysics.hh"
+#include "G4RunManagerKernel.hh"
+#include "G4VModularPhysicsList.hh"
+#include "G4ProductionCuts.hh"
 #include "G4SDManager.hh"
 #include "G4MultiFunctionalDetector.hh"
 #include "G4VPrimitiveScorer.hh"
-#include "G4PSEnergyDeposit.hh"
 #include "G4PSDoseDeposit.hh"
 #include "G4VisAttributes.hh"
 #include "G4PhysicalConstants.hh"
 #include "G4SystemOfUnits.hh"
 
+#include <algorithm>
+#include <sstream>
+
+G4ThreadLocal B3ResponseModel* B3DetectorConstruction::fgResponseModel = 0;
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 B3DetectorConstruction::B3DetectorConstruction()
 : G4VUserDetectorConstruction(),
-  fCheckOverlaps(true)
-{}
+  fNbCrystals(45),
+  fNbRings(35),
+  fCrystalDX(3.5*mm),
+  fCrystalDY(3.5*mm),
+  fCrystalDZ(1.*mm),
+  fGap(0.3*mm),
+  fCrystalMaterial(0),
+  fCrystalMaterialName("G4_CADMIUM_TELLURIDE"),
+  fMoMass(0.1*mg),
+  fResponseLibrary(),
+  fFastSimulation(0),
+  fGdmlWriteFile(),
+  fCrystalParameterisation(0),
+  fVoxelPhantom(0),
+  fOverlapCheck(0),
+  fMessenger(0)
+{
+  fVoxelPhantom = new B3VoxelPhantom();
+  fOverlapCheck = new B3OverlapCheck();
+  fMessenger = new B3DetectorMessenger(this);
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 B3DetectorConstruction::~B3DetectorConstruction()
-{ }
+{
+  delete fMessenger;
+  delete fVoxelPhantom;
+  delete fCrystalParameterisation;
+  delete fOverlapCheck;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void B3DetectorConstruction::SetResponseLibrary(const G4String& name)
+{
+  fResponseLibrary = name;
+
+  // the photons reach the response model through the fast simulation
+  // process, only added to them when there is a library (PreInit)
+  G4VModularPhysicsList* physicsList = dynamic_cast<G4VModularPhysicsList*>(
+    G4RunManagerKernel::GetRunManagerKernel()->GetPhysicsList());
+  if (!physicsList) {
+    G4Exception("B3DetectorConstruction::SetResponseLibrary()", "MyCode0012",
+                FatalException, "The response library needs a modular"
+                " physics list, set before the library.");
+    return;
+  }
+  if (!name.empty() && !fFastSimulation) {
+    fFastSimulation = new G4FastSimulationPhysics();
+    fFastSimulation->ActivateFastSimulation("gamma");
+    physicsList->RegisterPhysics(fFastSimulation);
+  }
+  else if (name.empty() && fFastSimulation) {
+    physicsList->RemovePhysics(fFastSimulation);
+    delete fFastSimulation;
+    fFastSimulation = 0;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 G4VPhysicalVolume* B3DetectorConstruction::Construct()
 {
+  // a rebuild after /B3/det/... in the Idle state replaces the previous
+  // geometry, as G4RunManager::ReinitializeGeometry(true) would
+  if (G4PhysicalVolumeStore::GetInstance()->size() > 0) {
+    ClearGeometry();
+  }
+
+  G4VPhysicalVolume* physWorld = ConstructVolumes();
+
+  // the Mo of the phantom is in the voxel materials, within the Patient
+  // region: the MoSolution cut and de-excitation do not apply to it
+  if (fVoxelPhantom->IsDefined()) {
+    G4ExceptionDescription msg;
+    msg << "The voxel phantom has no \"MoSolution\" region: its Mo voxels"
+        << " have the cut of the \"Patient\" region and no de-excitation"
+        << " unless set for it, e.g.\n"
+        << "  /process/em/deexcitation Patient true true true\n"
+        << "  /run/setCutForRegion Patient 0.1 um";
+    G4Exception("B3DetectorConstruction::Construct()", "MyCode0005",
+                JustWarning, msg);
+  }
+
+  // serial check on the master, skipped when the geometry hash is cached
+  fOverlapCheck->Check(physWorld);
+
+  if (!fGdmlWriteFile.empty()) {
+    B3GeometrySnapshot::Write(fGdmlWriteFile, physWorld, this);
+  }
+
+  //always return the physical World
+  //
+  return physWorld;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4VPhysicalVolume* B3DetectorConstruction::ConstructVolumes()
+{
+  if (fGap >= std::min(fCrystalDX, fCrystalDY)) {
+    G4ExceptionDescription msg;
+    msg << "The gap (" << fGap/mm << " mm) must be smaller than the"
+        << " crystal (" << fCrystalDX/mm << " x " << fCrystalDY/mm << " mm).";
+    G4Exception("B3DetectorConstruction::Construct()", "MyCode0014",
+                FatalException, msg);
+  }
+
   // Gamma detector Parameters
   //
-  G4double cryst_dX = 3.5*mm, cryst_dY = 3.5*mm, cryst_dZ = 1.*mm;
-  G4int nb_cryst = 45;
-  G4int nb_rings = 35;
+  G4double cryst_dX = fCrystalDX, cryst_dY = fCrystalDY, cryst_dZ = fCrystalDZ;
+  G4int nb_cryst = fNbCrystals;
+  G4int nb_rings = fNbRings;
   //
   G4double dPhi = twopi/nb_cryst, half_dPhi = 0.5*dPhi;
   G4double cosdPhi = std::cos(half_dPhi);
   G4double tandPhi = std::tan(half_dPhi);
   //
-  G4double ring_R1 = 0.5*cryst_dY/tandPhi;
+  G4double ring_R1 = GetRingInnerRadius();
   G4double ring_R2 = (ring_R1+cryst_dZ)/cosdPhi;
   //
   G4double detector_dZ = nb_rings*cryst_dX;
   //
   G4NistManager* nist = G4NistManager::Instance();
   G4Material* default_mat = nist->FindOrBuildMaterial("G4_AIR");//("G4_AIR");G4_Galactic
-  G4Material* cryst_mat   = nist->FindOrBuildMaterial("G4_CADMIUM_TELLURIDE");//("G4_Si");G4_CADMIUM_TELLURIDE //G4_GALLIUM_ARSENIDE //G4_Si
+  G4Material* cryst_mat   = nist->FindOrBuildMaterial(fCrystalMaterialName);//G4_CADMIUM_TELLURIDE, G4_GALLIUM_ARSENIDE, G4_Si
+  fCrystalMaterial = cryst_mat;
 
   G4cout << "\nNb of crystals: " << nb_cryst
          << "\nNb of rings: " << nb_rings
+         << "\nCrystal: " << cryst_dX/mm << " x " << cryst_dY/mm << " x "
+         << cryst_dZ/mm << " mm of " << cryst_mat->GetName()
+         << ", gap " << fGap/mm << " mm"
          << "\nInternal radius: " << ring_R1/cm << " cm"
          << "\nDetector lenth: " << detector_dZ/cm << " cm" << G4endl;
 
@@ -109,10 +232,21 @@ G4VPhysicalVolume* B3DetectorConstruction::Construct()
                       0,                     //its mother  volume
                       false,                 //no boolean operation
                       0,                     //copy number
-                      fCheckOverlaps);       // checking overlaps
+                      false);                // overlaps checked at the end
+
+  //
+  // full detector
+  //
+  G4Tubs* solidDetector =
+    new G4Tubs("Detector", ring_R1, ring_R2, 0.5*detector_dZ, 0., twopi);
+
+  G4LogicalVolume* logicDetector =
+    new G4LogicalVolume(solidDetector,       //its solid
+                        default_mat,         //its material
+                        "Detector");         //its name
 
   //
-  // ring
+  // rings, replicated along z in the detector
   //
   G4Tubs* solidRing =
     new G4Tubs("Ring", ring_R1, ring_R2, 0.5*cryst_dX, 0., twopi);
@@ -122,15 +256,17 @@ G4VPhysicalVolume* B3DetectorConstruction::Construct()
                         default_mat,         //its material
                         "Ring");             //its name
 
-  G4LogicalVolume* logicRing_0 =
-    new G4LogicalVolume(solidRing,           //its solid
-                        default_mat,         //its material
-                        "Ring_0");             //its name
+  new G4PVReplica("ring",                    //its name
+                  logicRing,                 //its logical volume
+                  logicDetector,             //its mother  volume
+                  kZAxis,                    //axis of replication
+                  nb_rings,                  //number of replica
+                  cryst_dX);                 //width of replica
 
   //
   // define crystal
   //
-  G4double gap = 0.3*mm;        //a gap for wrapping
+  G4double gap = fGap;          //a gap for wrapping
   G4double dX = cryst_dX - gap, dY = cryst_dY - gap;
   G4Box* solidCryst = new G4Box("crystal", dX/2, dY/2, cryst_dZ/2);
 
@@ -139,77 +275,7 @@ G4VPhysicalVolume* B3DetectorConstruction::Construct()
                         cryst_mat,           //its material
                         "CrystalLV");        //its name
 
-  // place crystals within a ring
-  //
-  for (G4int icrys = 0; icrys < nb_cryst ; icrys++) {
-    G4double phi = icrys*dPhi;
-    G4RotationMatrix rotm  = G4RotationMatrix();
-    rotm.rotateY(90*deg);
-    rotm.rotateZ(phi);
-    G4ThreeVector uz = G4ThreeVector(std::cos(phi),  std::sin(phi),0.);
-    G4ThreeVector position = (ring_R1+0.5*cryst_dZ)*uz;
-    G4Transform3D transform = G4Transform3D(rotm,position);
-    if (icrys != 0)
-    {
-    //fCrystalPV =
-    new G4PVPlacement(transform,             //rotation,position
-                      logicCryst,            //its logical volume
-                      "crystal_0",             //its name
-                      logicRing_0,             //its mother  volume
-                      false,                 //no boolean operation
-                      icrys,                 //copy number
-                      fCheckOverlaps);       // checking overlaps
-    }
-    new G4PVPlacement(transform,             //rotation,position
-                      logicCryst,            //its logical volume
-                      "crystal",             //its name
-                      logicRing,             //its mother  volume
-                      false,                 //no boolean operation
-                      icrys,                 //copy number
-                      fCheckOverlaps);       // checking overlaps
-  }
-
-
-  //
-  // full detector
-  //
-  G4Tubs* solidDetector =
-    new G4Tubs("Detector", ring_R1, ring_R2, 0.5*detector_dZ, 0., twopi);
-
-  G4LogicalVolume* logicDetector =
-    new G4LogicalVolume(solidDetector,       //its solid
-                        default_mat,         //its material
-                        "Detector");         //its name
-
-  //
-  // place rings within detector
-  //
-  G4double OG = -0.5*(detector_dZ + cryst_dX);
-  for (G4int iring = 0; iring < nb_rings ; iring++) {
-    OG += cryst_dX;
-    if (iring != 17)  // 35 rings/2 = 17.5
-    {
-    new G4PVPlacement(0,                     //no rotation
-                      G4ThreeVector(0,0,OG), //position
-                      logicRing,             //its logical volume
-                      "ring",                //its name
-                      logicDetector,         //its mother  volume
-                      false,                 //no boolean operation
-                      iring,                 //copy number
-                      fCheckOverlaps);       // checking overlaps
-    }
-    else
-    {
-    new G4PVPlacement(0,                     //no rotation
-                      G4ThreeVector(0,0,OG), //position
-                      logicRing_0,             //its logical volume
-                      "ring",                //its name
-                      logicDetector,         //its mother  volume
-                      false,                 //no boolean operation
-                      iring,                 //copy number
-                      fCheckOverlaps);       // checking overlaps
-    }
-  }
+  PlaceCrystals(logicCryst, logicRing, default_mat);
 
   //
   // place detector in world
@@ -222,12 +288,67 @@ G4VPhysicalVolume* B3DetectorConstruction::Construct()
                     logicWorld,              //its mother  volume
                     false,                   //no boolean operation
                     0,                       //copy number
-                    fCheckOverlaps);         // checking overlaps
+                    false);                  // overlaps checked at the end
 
 
   //
   // Mouse
   //
+  G4LogicalVolume* logicPatient = 0;
+  if (fVoxelPhantom->IsDefined()) {
+    CheckPatientFits(fVoxelPhantom->GetHalfSize(), ring_R1, 0.5*world_sizeZ);
+    logicPatient = fVoxelPhantom->Construct(logicWorld);
+  }
+  else {
+    logicPatient = ConstructPatient(logicWorld);
+  }
+
+  // Visualization attributes
+  //
+  logicRing->SetVisAttributes (G4VisAttributes::GetInvisible());
+  logicDetector->SetVisAttributes (G4VisAttributes::GetInvisible());
+  logicWorld->SetVisAttributes (G4VisAttributes::GetInvisible());
+
+  // Regions: the small gamma cut is only needed where the
+  // fluorescence is produced and detected
+  //
+  SetupRegion("Patient", logicPatient, 0.1*mm);
+  SetupRegion("Detector", logicDetector, 0.0001*mm);
+
+  // Print materials
+  G4cout << *(G4Material::GetMaterialTable()) << G4endl;
+
+  return physWorld;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3DetectorConstruction::PlaceCrystals(G4LogicalVolume* logicCryst,
+                                           G4LogicalVolume* logicRing,
+                                           G4Material* holeMaterial)
+{
+  // crystals parameterised within a ring, copy number = crystal;
+  // the beam hole is the crystal 0 of the central ring, made of air
+  //
+  delete fCrystalParameterisation;
+  fCrystalParameterisation = new B3CrystalParameterisation(
+    this, logicCryst->GetMaterial(), holeMaterial);
+  new G4PVParameterised("crystal",           //its name
+                        logicCryst,          //its logical volume
+                        logicRing,           //its mother  volume
+                        kUndefined,          //voxelised on all axes
+                        fNbCrystals,         //number of crystals
+                        fCrystalParameterisation, //its parameterisation
+                        false);              //overlaps checked at the end
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4LogicalVolume* 
+B3DetectorConstruction::ConstructPatient(G4LogicalVolume* logicWorld)
+{
+  G4NistManager* nist = G4NistManager::Instance();
+
   G4double patient_radius = 2.0*cm; // 2*cm
   G4double patient_dZ = 10.0*cm; //10*cm
   G4Material* patient_mat = nist->FindOrBuildMaterial("G4_A-150_TISSUE");              //G4_A-150_TISSUE
@@ -251,7 +372,7 @@ G4VPhysicalVolume* B3DetectorConstruction::Construct()
                     logicWorld,              //its mother  volume
                     false,                   //no boolean operation
                     0,                       //copy number
-                    fCheckOverlaps);         // checking overlaps
+                    false);                  // overlaps checked at the end
 
   auto Patient_color = new G4VisAttributes(G4Colour(0.,0.,1.0));
   Patient_color->SetVisibility(true);
@@ -261,32 +382,13 @@ G4VPhysicalVolume* B3DetectorConstruction::Construct()
   //
   // Mo Solution
   //
-  G4Material* Mo_mat = nist->FindOrBuildMaterial("G4_Mo");
-  G4double density_Mo = Mo_mat->GetDensity();
-  G4double mass_Mo = 0.1*mg;//e-01*mg;  // 1.e-03mg per mm3 minimum, 1.e-02mg per cm3
-  G4double vol_Mo = mass_Mo / density_Mo;
-
-  G4Material* Water_mat = nist->FindOrBuildMaterial("G4_A-150_TISSUE"); //G4_A-150_TISSUE //G4_WATER
-  G4double density_water = Water_mat->GetDensity();
-
+  G4double mass_Mo = fMoMass;//e-01*mg;  // 1.e-03mg per mm3 minimum, 1.e-02mg per cm3
   G4double vol_sol = 1.*mm3;
-
-  G4double vol_water = vol_sol - vol_Mo;
-  G4double mass_water = density_water * vol_water;
-
-
-  G4double mass_sol = mass_Mo + mass_water;
-  G4double density_sol = mass_sol / vol_sol;
-
-  G4double w_Mo = mass_Mo / (mass_Mo + mass_water); // Mo %
+  // one material per Mo mass, as materials are never deleted
+  std::ostringstream solutionName;
+  solutionName << "Mo_Solution_" << mass_Mo/mg << "mg";
   G4Material* Mo_Solution_mat =
-  new G4Material("Mo_Solution", // name
-                 density_sol,   // density
-                 2);            // nb of components
-  Mo_Solution_mat->AddMaterial(Mo_mat, // material
-                               w_Mo);  // fraction mass
-  Mo_Solution_mat->AddMaterial(Water_mat, // material
-                               1.-w_Mo);  // fraction mass
+    BuildMoSolution(solutionName.str(), patient_mat, mass_Mo/vol_sol);
 
   G4double sol_dl = pow(vol_sol, (1./3.)); // Cube Volume
 //  G4double xpos = G4UniformRand()*18.;
@@ -294,11 +396,9 @@ G4VPhysicalVolume* B3DetectorConstruction::Construct()
   G4ThreeVector sol_pos = G4ThreeVector();
 
   G4cout << "Mo mass: " << mass_Mo/mg << " mg" << G4endl
-         << "Mo vol: " << vol_Mo/mm3 << " mm3" << G4endl
-         << "Medium mass: " << mass_water/mg << " mg" << G4endl
-         << "Medium vol: " << vol_water/mm3 << " mm3" << G4endl
-         << "Solution mass: " << mass_sol/mg << " mg" << G4endl
          << "Solution vol: " << vol_sol/mm3 << " mm3" << G4endl
+         << "Solution density: "
+         << Mo_Solution_mat->GetDensity()/(g/cm3) << " g/cm3" << G4endl
          << "Cube side: " << sol_dl/mm << " mm" << G4endl;
 
   G4Box* solidSol =
@@ -320,57 +420,212 @@ G4VPhysicalVolume* B3DetectorConstruction::Construct()
                     logicPatient,              //its mother  volume
                     false,                   //no boolean operation
                     0,                       //copy number
-                    fCheckOverlaps);         // checking overlaps
+                    false);                  // overlaps checked at the end
 
   auto sol_color = new G4VisAttributes(G4Colour(1.0,0.8,0.8));
   sol_color->SetVisibility(true);
   logicSol->SetVisAttributes(sol_color);
 
+  // the small gamma cut is only needed where the fluorescence is produced
+  SetupRegion("MoSolution", logicSol, 0.0001*mm);
 
+  return logicPatient;
+}
 
-  // Visualization attributes
-  //
-  logicRing->SetVisAttributes (G4VisAttributes::GetInvisible());
-  logicDetector->SetVisAttributes (G4VisAttributes::GetInvisible());
-  logicWorld->SetVisAttributes (G4VisAttributes::GetInvisible());
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void B3DetectorConstruction::CheckPatientFits(const G4ThreeVector& halfSize,
+                                              G4double ringRadius,
+                                              G4double worldHalfZ) const
+{
+  G4double halfDiagonal = std::sqrt(halfSize.x()*halfSize.x()
+                                    + halfSize.y()*halfSize.y());
+  if (halfDiagonal < ringRadius && halfSize.z() < worldHalfZ) return;
+
+  G4ExceptionDescription msg;
+  msg << "The voxel phantom (" << 2*halfSize/mm << " mm) does not fit"
+      << " inside the detector ring of radius " << ringRadius/mm << " mm.";
+  G4Exception("B3DetectorConstruction::Construct()", "MyCode0005",
+              FatalException, msg);
+}
 
-  // Print materials
-  G4cout << *(G4Material::GetMaterialTable()) << G4endl;
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-  //always return the physical World
-  //
-  return physWorld;
+G4Material* B3DetectorConstruction::BuildMoSolution(const G4String& name,
+                                                    G4Material* medium,
+                                                    G4double concentration)
+{
+  if (concentration <= 0.) return medium;
+
+  // materials are kept in a global table: reuse on a geometry rebuild
+  G4Material* solution = G4Material::GetMaterial(name, false);
+  if (solution) return solution;
+
+  // the Mo takes the place of its own volume of medium
+  G4Material* Mo_mat = G4NistManager::Instance()->FindOrBuildMaterial("G4_Mo");
+  G4double density = concentration
+    + medium->GetDensity()*(1. - concentration/Mo_mat->GetDensity());
+  G4double w_Mo = concentration/density;
+
+  solution = new G4Material(name,      // name
+                            density,   // density
+                            2);        // nb of components
+  solution->AddMaterial(Mo_mat, w_Mo);     // fraction mass
+  solution->AddMaterial(medium, 1.-w_Mo);  // fraction mass
+  return solution;
 }
 
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3DetectorConstruction::ClearGeometry()
+{
+  G4GeometryManager::GetInstance()->OpenGeometry();
+
+  // the regions and their cuts are kept, without their root volumes;
+  // the world region is updated by the run manager kernel
+  G4RegionStore* regionStore = G4RegionStore::GetInstance();
+  for (size_t i = 0; i < regionStore->size(); ++i) {
+    G4Region* region = (*regionStore)[i];
+    if (region->GetName() == "DefaultRegionForTheWorld") continue;
+    std::vector<G4LogicalVolume*> roots(
+      region->GetRootLogicalVolumeIterator(),
+      region->GetRootLogicalVolumeIterator() + region->GetNumberOfRootVolumes());
+    for (size_t j = 0; j < roots.size(); ++j) {
+      region->RemoveRootLogicalVolume(roots[j], false);
+    }
+  }
+
+  G4PhysicalVolumeStore::GetInstance()->Clean();
+  G4LogicalVolumeStore::GetInstance()->Clean();
+  G4SolidStore::GetInstance()->Clean();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3DetectorConstruction::SetCrystalMaterial(const G4String& name)
+{
+  if (!G4NistManager::Instance()->FindOrBuildMaterial(name)) {
+    G4ExceptionDescription msg;
+    msg << "Unknown material " << name << "; the crystals are kept in "
+        << fCrystalMaterialName << ".";
+    G4Exception("B3DetectorConstruction::SetCrystalMaterial()",
+                "MyCode0014", JustWarning, msg);
+    return false;
+  }
+  fCrystalMaterialName = name;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+G4double B3DetectorConstruction::GetRingInnerRadius() const
+{
+  return 0.5*fCrystalDY/std::tan(0.5*twopi/fNbCrystals);
+}
 
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreeVector B3DetectorConstruction::GetPixelDirection(G4int pixel) const
+{
+  G4double phi = (pixel % fNbCrystals)*twopi/fNbCrystals;
+  return G4ThreeVector(std::cos(phi), std::sin(phi), 0.);
+}
 
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+G4ThreeVector B3DetectorConstruction::GetPixelEntrance(G4int pixel) const
+{
+  G4int ring = pixel / fNbCrystals;
+  G4double z = (ring + 0.5 - 0.5*fNbRings)*fCrystalDX;
+  return GetRingInnerRadius()*GetPixelDirection(pixel) + G4ThreeVector(0.,0.,z);
+}
 
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void B3DetectorConstruction::SetupRegion(const G4String& name,
+                                         G4LogicalVolume* rootVolume,
+                                         G4double gammaCut)
+{
+  G4Region* region = G4RegionStore::GetInstance()->FindOrCreateRegion(name);
+  region->AddRootLogicalVolume(rootVolume);
+
+  // default cuts only for a new region, so that values set with
+  // /run/setCutForRegion survive a geometry rebuild
+  if (!region->GetProductionCuts()) {
+    G4ProductionCuts* cuts = new G4ProductionCuts();
+    cuts->SetProductionCut(0.7*mm);
+    cuts->SetProductionCut(gammaCut, "gamma");
+    region->SetProductionCuts(cuts);
+  }
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void B3DetectorConstruction::ConstructSDandField()
 {
-  G4SDManager::GetSDMpointer()->SetVerboseLevel(1);
+  G4SDManager* sdManager = G4SDManager::GetSDMpointer();
+  sdManager->SetVerboseLevel(1);
   
-  // declare crystal as a MultiFunctionalDetector scorer
+  // declare crystal as a pixel detector, addressed by (ring, crystal);
+  // a rebuilt geometry keeps the detectors of the thread, resized
   //  
-  G4MultiFunctionalDetector* cryst = new G4MultiFunctionalDetector("crystal");
-  G4SDManager::GetSDMpointer()->AddNewDetector(cryst);
-  G4VPrimitiveScorer* primitiv1 = new G4PSEnergyDeposit("edep");
-  cryst->RegisterPrimitive(primitiv1);
+  B3PixelSD* cryst
+    = static_cast<B3PixelSD*>(sdManager->FindSensitiveDetector("crystal", false));
+  if (cryst) {
+    cryst->SetSize(fNbCrystals, fNbRings);
+  }
+  else {
+    cryst = new B3PixelSD("crystal", fNbCrystals, fNbRings);
+    sdManager->AddNewDetector(cryst);
+  }
   SetSensitiveDetector("CrystalLV",cryst);
+  for (G4int ring = 0; ring < fNbRings; ++ring) {
+    for (G4int crystal = 0; crystal < fNbCrystals; ++crystal) {
+      if (IsBeamHole(ring, crystal)) {
+        cryst->SetDeadPixel(ring*fNbCrystals + crystal);
+      }
+    }
+  }
+
+  // replay of a response library in the ring, one model per thread
+  //
+  G4Region* detectorRegion = G4RegionStore::GetInstance()->GetRegion("Detector");
+  if (fgResponseModel) {
+    detectorRegion->GetFastSimulationManager()
+      ->RemoveFastSimulationModel(fgResponseModel);
+    delete fgResponseModel;
+    fgResponseModel = 0;
+  }
+  if (!fResponseLibrary.empty()) {
+    const B3ResponseLibrary* library = B3ResponseLibrary::Load(fResponseLibrary);
+    if (!library->MatchesCell(this)) {
+      G4ExceptionDescription msg;
+      msg << "The response library " << fResponseLibrary
+          << " was built for another crystal cell.";
+      G4Exception("B3DetectorConstruction::ConstructSDandField()",
+                  "MyCode0012", FatalException, msg);
+    }
+    fgResponseModel
+      = new B3ResponseModel(library, this, cryst, detectorRegion);
+  }
   
-  // declare patient as a MultiFunctionalDetector scorer
+  // declare patient as a MultiFunctionalDetector scorer;
+  // with the voxel phantom, the dose is scored per voxel copy number
   //  
-  G4MultiFunctionalDetector* patient = new G4MultiFunctionalDetector("patient");
-  G4SDManager::GetSDMpointer()->AddNewDetector(patient);
-  G4VPrimitiveScorer* primitiv2 = new G4PSDoseDeposit("dose");
-  patient->RegisterPrimitive(primitiv2);
-  SetSensitiveDetector("PatientLV",patient);
+  G4VSensitiveDetector* patient = sdManager->FindSensitiveDetector("patient", false);
+  if (!patient) {
+    G4MultiFunctionalDetector* scorer = new G4MultiFunctionalDetector("patient");
+    sdManager->AddNewDetector(scorer);
+    G4VPrimitiveScorer* primitiv2 = new G4PSDoseDeposit("dose");
+    scorer->RegisterPrimitive(primitiv2);
+    patient = scorer;
+  }
+  if (fVoxelPhantom->IsDefined()) {
+    SetSensitiveDetector("VoxelLV",patient);
+  }
+  else {
+    SetSensitiveDetector("PatientLV",patient);
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
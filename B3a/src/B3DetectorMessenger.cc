@@ -0,0 +1,310 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3DetectorMessenger.cc
+/// \brief Implementation of the B3DetectorMessenger class
+
+#include "B3DetectorMessenger.hh"
+#include "B3DetectorConstruction.hh"
+#include "B3VoxelPhantom.hh"
+#include "B3OverlapCheck.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWith3VectorAndUnit.hh"
+#include "G4RunManager.hh"
+#include "G4StateManager.hh"
+
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3DetectorMessenger::B3DetectorMessenger(B3DetectorConstruction* detector)
+ : G4UImessenger(),
+   fDetector(detector),
+   fDetDir(0),
+   fPhantomDir(0),
+   fNbCrystalsCmd(0),
+   fNbRingsCmd(0),
+   fCrystalSizeCmd(0),
+   fGapCmd(0),
+   fCrystalMaterialCmd(0),
+   fMoMassCmd(0),
+   fResponseLibraryCmd(0),
+   fOverlapsDir(0),
+   fOverlapsCheckCmd(0),
+   fOverlapsForceCmd(0),
+   fOverlapsCacheCmd(0),
+   fGdmlDir(0),
+   fGdmlWriteCmd(0),
+   fIndexFileCmd(0),
+   fMaterialFileCmd(0),
+   fMoMapFileCmd(0),
+   fNbVoxelsCmd(0),
+   fVoxelSizeCmd(0)
+{
+  fDetDir = new G4UIdirectory("/B3/det/", false);
+  fDetDir->SetGuidance("Detector construction control.");
+
+  fNbCrystalsCmd = new G4UIcmdWithAnInteger("/B3/det/nbCrystals",this);
+  fNbCrystalsCmd->SetGuidance("Number of crystals in a ring.");
+  fNbCrystalsCmd->SetParameterName("nbCrystals",false);
+  fNbCrystalsCmd->SetRange("nbCrystals>=3");
+  fNbCrystalsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fNbCrystalsCmd->SetToBeBroadcasted(false);
+
+  fNbRingsCmd = new G4UIcmdWithAnInteger("/B3/det/nbRings",this);
+  fNbRingsCmd->SetGuidance("Number of rings; the beam hole is in the central one.");
+  fNbRingsCmd->SetParameterName("nbRings",false);
+  fNbRingsCmd->SetRange("nbRings>=1");
+  fNbRingsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fNbRingsCmd->SetToBeBroadcasted(false);
+
+  fCrystalSizeCmd = new G4UIcmdWith3VectorAndUnit("/B3/det/crystalSize",this);
+  fCrystalSizeCmd->SetGuidance("Pitch of a crystal along the rings and");
+  fCrystalSizeCmd->SetGuidance("across them, gap included, and thickness.");
+  fCrystalSizeCmd->SetParameterName("dx","dy","dz",false);
+  fCrystalSizeCmd->SetRange("dx>0. && dy>0. && dz>0.");
+  fCrystalSizeCmd->SetUnitCategory("Length");
+  fCrystalSizeCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fCrystalSizeCmd->SetToBeBroadcasted(false);
+
+  fGapCmd = new G4UIcmdWithADoubleAndUnit("/B3/det/gap",this);
+  fGapCmd->SetGuidance("Gap for the wrapping between the crystals.");
+  fGapCmd->SetParameterName("gap",false);
+  fGapCmd->SetRange("gap>=0.");
+  fGapCmd->SetUnitCategory("Length");
+  fGapCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fGapCmd->SetToBeBroadcasted(false);
+
+  fCrystalMaterialCmd = new G4UIcmdWithAString("/B3/det/crystalMaterial",this);
+  fCrystalMaterialCmd->SetGuidance("NIST material of the crystals, e.g.");
+  fCrystalMaterialCmd->SetGuidance("G4_CADMIUM_TELLURIDE, G4_GALLIUM_ARSENIDE, G4_Si.");
+  fCrystalMaterialCmd->SetParameterName("material",false);
+  fCrystalMaterialCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fCrystalMaterialCmd->SetToBeBroadcasted(false);
+
+  fMoMassCmd = new G4UIcmdWithADoubleAndUnit("/B3/det/moMass",this);
+  fMoMassCmd->SetGuidance("Mass of Mo in the 1 mm3 solution of the default patient.");
+  fMoMassCmd->SetParameterName("mass",false);
+  fMoMassCmd->SetRange("mass>=0.");
+  fMoMassCmd->SetUnitCategory("Mass");
+  fMoMassCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fMoMassCmd->SetToBeBroadcasted(false);
+
+  fResponseLibraryCmd = new G4UIcmdWithAString("/B3/det/responseLibrary",this);
+  fResponseLibraryCmd->SetGuidance("Replace the transport in the crystals by");
+  fResponseLibraryCmd->SetGuidance("this response library; none to stop.");
+  fResponseLibraryCmd->SetParameterName("fileName",false);
+  fResponseLibraryCmd->AvailableForStates(G4State_PreInit);
+  fResponseLibraryCmd->SetToBeBroadcasted(false);
+
+  fOverlapsDir = new G4UIdirectory("/B3/det/overlaps/", false);
+  fOverlapsDir->SetGuidance("Overlap check of the constructed geometry.");
+
+  fOverlapsCheckCmd = new G4UIcmdWithABool("/B3/det/overlaps/check",this);
+  fOverlapsCheckCmd->SetGuidance("Check the overlaps of all the volumes.");
+  fOverlapsCheckCmd->SetParameterName("check",true);
+  fOverlapsCheckCmd->SetDefaultValue(true);
+  fOverlapsCheckCmd->AvailableForStates(G4State_PreInit);
+  fOverlapsCheckCmd->SetToBeBroadcasted(false);
+
+  fOverlapsForceCmd = new G4UIcmdWithABool("/B3/det/overlaps/force",this);
+  fOverlapsForceCmd->SetGuidance("Check even a geometry found in the cache.");
+  fOverlapsForceCmd->SetParameterName("force",true);
+  fOverlapsForceCmd->SetDefaultValue(true);
+  fOverlapsForceCmd->AvailableForStates(G4State_PreInit);
+  fOverlapsForceCmd->SetToBeBroadcasted(false);
+
+  fOverlapsCacheCmd = new G4UIcmdWithAString("/B3/det/overlaps/cacheFile",this);
+  fOverlapsCacheCmd->SetGuidance("File of the geometries without overlaps;");
+  fOverlapsCacheCmd->SetGuidance("none to check every time.");
+  fOverlapsCacheCmd->SetParameterName("fileName",false);
+  fOverlapsCacheCmd->AvailableForStates(G4State_PreInit);
+  fOverlapsCacheCmd->SetToBeBroadcasted(false);
+
+  fGdmlDir = new G4UIdirectory("/B3/det/gdml/", false);
+  fGdmlDir->SetGuidance("GDML export of the constructed geometry.");
+
+  fGdmlWriteCmd = new G4UIcmdWithAString("/B3/det/gdml/write",this);
+  fGdmlWriteCmd->SetGuidance("Write the geometry to this snapshot each time");
+  fGdmlWriteCmd->SetGuidance("it is constructed; none to stop.");
+  fGdmlWriteCmd->SetParameterName("fileName",false);
+  fGdmlWriteCmd->AvailableForStates(G4State_PreInit);
+  fGdmlWriteCmd->SetToBeBroadcasted(false);
+
+  fPhantomDir = new G4UIdirectory("/B3/det/phantom/", false);
+  fPhantomDir->SetGuidance("Voxel phantom replacing the default patient.");
+
+  fIndexFileCmd = new G4UIcmdWithAString("/B3/det/phantom/indexFile",this);
+  fIndexFileCmd->SetGuidance("Raw file of uint8 material indices,");
+  fIndexFileCmd->SetGuidance("x running fastest, then y, then z.");
+  fIndexFileCmd->SetParameterName("fileName",false);
+  fIndexFileCmd->AvailableForStates(G4State_PreInit);
+  fIndexFileCmd->SetToBeBroadcasted(false);
+
+  fMaterialFileCmd = new G4UIcmdWithAString("/B3/det/phantom/materialFile",this);
+  fMaterialFileCmd->SetGuidance("Material table: 'index G4_MATERIAL' lines and");
+  fMaterialFileCmd->SetGuidance("'Mo level concentration' lines (mg/cm3).");
+  fMaterialFileCmd->SetParameterName("fileName",false);
+  fMaterialFileCmd->AvailableForStates(G4State_PreInit);
+  fMaterialFileCmd->SetToBeBroadcasted(false);
+
+  fMoMapFileCmd = new G4UIcmdWithAString("/B3/det/phantom/moMapFile",this);
+  fMoMapFileCmd->SetGuidance("Raw file of uint8 Mo levels, in the voxel order.");
+  fMoMapFileCmd->SetParameterName("fileName",false);
+  fMoMapFileCmd->AvailableForStates(G4State_PreInit);
+  fMoMapFileCmd->SetToBeBroadcasted(false);
+
+  fNbVoxelsCmd = new G4UIcommand("/B3/det/phantom/nbVoxels",this);
+  fNbVoxelsCmd->SetGuidance("Number of voxels along x, y and z.");
+  const char* axes[3] = { "nx", "ny", "nz" };
+  for (G4int i = 0; i < 3; ++i) {
+    G4UIparameter* parameter = new G4UIparameter(axes[i],'i',false);
+    parameter->SetParameterRange(G4String(axes[i]) + " > 0");
+    fNbVoxelsCmd->SetParameter(parameter);
+  }
+  fNbVoxelsCmd->AvailableForStates(G4State_PreInit);
+  fNbVoxelsCmd->SetToBeBroadcasted(false);
+
+  fVoxelSizeCmd = new G4UIcmdWith3VectorAndUnit("/B3/det/phantom/voxelSize",this);
+  fVoxelSizeCmd->SetGuidance("Full size of a voxel along x, y and z.");
+  fVoxelSizeCmd->SetParameterName("dx","dy","dz",false);
+  fVoxelSizeCmd->SetUnitCategory("Length");
+  fVoxelSizeCmd->AvailableForStates(G4State_PreInit);
+  fVoxelSizeCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3DetectorMessenger::~B3DetectorMessenger()
+{
+  delete fNbCrystalsCmd;
+  delete fNbRingsCmd;
+  delete fCrystalSizeCmd;
+  delete fGapCmd;
+  delete fCrystalMaterialCmd;
+  delete fMoMassCmd;
+  delete fResponseLibraryCmd;
+  delete fOverlapsCheckCmd;
+  delete fOverlapsForceCmd;
+  delete fOverlapsCacheCmd;
+  delete fOverlapsDir;
+  delete fGdmlWriteCmd;
+  delete fGdmlDir;
+  delete fIndexFileCmd;
+  delete fMaterialFileCmd;
+  delete fMoMapFileCmd;
+  delete fNbVoxelsCmd;
+  delete fVoxelSizeCmd;
+  delete fPhantomDir;
+  delete fDetDir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3DetectorMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  B3VoxelPhantom* phantom = fDetector->GetVoxelPhantom();
+
+  if ( command == fNbCrystalsCmd ) {
+    fDetector->SetNbCrystals(fNbCrystalsCmd->GetNewIntValue(newValue));
+    ReinitializeGeometry();
+  }
+  else if ( command == fNbRingsCmd ) {
+    fDetector->SetNbRings(fNbRingsCmd->GetNewIntValue(newValue));
+    ReinitializeGeometry();
+  }
+  else if ( command == fCrystalSizeCmd ) {
+    fDetector->SetCrystalSize(fCrystalSizeCmd->GetNew3VectorValue(newValue));
+    ReinitializeGeometry();
+  }
+  else if ( command == fGapCmd ) {
+    fDetector->SetGap(fGapCmd->GetNewDoubleValue(newValue));
+    ReinitializeGeometry();
+  }
+  else if ( command == fCrystalMaterialCmd ) {
+    if (fDetector->SetCrystalMaterial(newValue)) ReinitializeGeometry();
+  }
+  else if ( command == fMoMassCmd ) {
+    fDetector->SetMoMass(fMoMassCmd->GetNewDoubleValue(newValue));
+    ReinitializeGeometry();
+  }
+  else if ( command == fResponseLibraryCmd ) {
+    fDetector->SetResponseLibrary(newValue == "none" ? G4String() : newValue);
+  }
+  else if ( command == fOverlapsCheckCmd ) {
+    fDetector->GetOverlapCheck()->SetEnabled(
+      fOverlapsCheckCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fOverlapsForceCmd ) {
+    fDetector->GetOverlapCheck()->SetForced(
+      fOverlapsForceCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fOverlapsCacheCmd ) {
+    fDetector->GetOverlapCheck()->SetCacheFile(
+      newValue == "none" ? G4String() : newValue);
+  }
+  else if ( command == fGdmlWriteCmd ) {
+    fDetector->SetGdmlWriteFile(newValue == "none" ? G4String() : newValue);
+  }
+  else if ( command == fIndexFileCmd ) {
+    phantom->SetIndexFile(newValue);
+  }
+  else if ( command == fMaterialFileCmd ) {
+    phantom->SetMaterialFile(newValue);
+  }
+  else if ( command == fMoMapFileCmd ) {
+    phantom->SetMoMapFile(newValue);
+  }
+  else if ( command == fNbVoxelsCmd ) {
+    G4int nx = 0, ny = 0, nz = 0;
+    std::istringstream is(newValue);
+    is >> nx >> ny >> nz;
+    phantom->SetNbVoxels(nx, ny, nz);
+  }
+  else if ( command == fVoxelSizeCmd ) {
+    phantom->SetVoxelSize(fVoxelSizeCmd->GetNew3VectorValue(newValue));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3DetectorMessenger::ReinitializeGeometry() const
+{
+  // before /run/initialize, the geometry is not built yet
+  if (G4StateManager::GetStateManager()->GetCurrentState() != G4State_Idle) {
+    return;
+  }
+  G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,276 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3Digitizer.cc
+/// \brief Implementation of the B3Digitizer class
+
+#include "B3Digitizer.hh"
+#include "B3ListMode.hh"
+
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+
+#ifdef B3_USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace
+{
+  // keV
+  const G4float kPairEnergy = 4.43e-3f;
+  const G4float kCdEdge = 26.711f, kCdKAlpha = 23.174f;
+  const G4float kTeEdge = 31.814f, kTeKAlpha = 27.472f;
+
+  void Warn(const G4String& method, const G4String& message)
+  {
+    G4Exception(("B3Digitizer::" + method + "()").c_str(), "MyCode0010",
+                JustWarning, message.c_str());
+  }
+
+  void Draw(CLHEP::HepRandomEngine& engine, G4bool gauss,
+            std::vector<G4float>& values, size_t size)
+  {
+    values.clear();
+    if (size == 0) return;
+    std::vector<G4double> draws(size);
+    if (gauss) CLHEP::RandGaussQ::shootArray(&engine, size, &draws[0]);
+    else       CLHEP::RandFlat::shootArray(&engine, size, &draws[0]);
+    values.assign(draws.begin(), draws.end());
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3Digitizer::B3Digitizer(G4int nbCrystals, G4int nbRings, G4double pitch)
+ : fNbCrystals(nbCrystals),
+   fNbRings(nbRings),
+   fPitch(pitch),
+   fNbEvents(0)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3Digitizer::~B3Digitizer()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3Digitizer::Read(const G4String& fileName)
+{
+  std::ifstream input(fileName, std::ios::binary);
+  char magic[4];
+  uint32_t header[3];
+  if (!input.read(magic, 4) || G4String(magic, 4) != "B3LM" ||
+      !input.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+      header[0] != 1 || header[1] != sizeof(B3ListModeRecord)) {
+    Warn("Read", "cannot read " + fileName + " as a list-mode file");
+    return false;
+  }
+  G4bool compressed = header[2] != 0;
+#ifndef B3_USE_ZLIB
+  if (compressed) {
+    Warn("Read", "built without zlib: cannot read " + fileName);
+    return false;
+  }
+#endif
+
+  std::vector<B3ListModeRecord> records;
+  std::vector<char> buffer;
+  G4int lastEvent = -1;
+  uint32_t chunk[2];
+  while (input.read(reinterpret_cast<char*>(chunk), sizeof(chunk))) {
+    records.resize(chunk[0]);
+    char* data = reinterpret_cast<char*>(records.data());
+    size_t nbBytes = records.size()*sizeof(B3ListModeRecord);
+    G4bool ok;
+    if (compressed) {
+      buffer.resize(chunk[1]);
+      ok = bool(input.read(buffer.data(), buffer.size()));
+#ifdef B3_USE_ZLIB
+      uLongf length = nbBytes;
+      ok = ok && uncompress(reinterpret_cast<Bytef*>(data), &length,
+                            reinterpret_cast<const Bytef*>(buffer.data()),
+                            buffer.size()) == Z_OK && length == nbBytes;
+#endif
+    }
+    else {
+      ok = chunk[1] == nbBytes && input.read(data, nbBytes);
+    }
+    if (!ok) {
+      Warn("Read", "truncated or corrupted chunk in " + fileName);
+      return false;
+    }
+
+    // the deposits of an event are consecutive in a file
+    for (size_t i = 0; i < records.size(); ++i) {
+      const B3ListModeRecord& record = records[i];
+      if (record.pixel < 0 || record.pixel >= fNbCrystals*fNbRings) {
+        Warn("Read", "pixel out of the detector in " + fileName +
+                     "; check the number of crystals and rings");
+        return false;
+      }
+      if (record.eventID != lastEvent) ++fNbEvents;
+      lastEvent = record.eventID;
+      fEvent.push_back(record.eventID);
+      fPixel.push_back(record.pixel);
+      fEdep.push_back(record.edep);
+    }
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3Digitizer::Prepare(G4long seed)
+{
+  CLHEP::MixMaxRng engine(seed);
+  size_t size = fEdep.size();
+  Draw(engine, true,  fFanoGauss, size);
+  Draw(engine, false, fEscapeFlat, size);
+  Draw(engine, false, fPositionU, size);
+  Draw(engine, false, fPositionV, size);
+  // one per signal: a deposit and its 4 neighbours
+  Draw(engine, true,  fNoiseGauss, 5*size);
+
+  fCharge.resize(size);
+  for (G4int k = 0; k < 4; ++k) fShare[k].resize(size);
+  fSignalPixel.reserve(5*size);
+  fSignal.reserve(5*size);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4long B3Digitizer::Digitize(const Parameters& parameters, G4double emax,
+                             std::vector<unsigned int>& spectrum)
+{
+  const size_t size = fEdep.size();
+  const G4float fano = parameters.fano*kPairEnergy;
+  const G4float escapeTe = parameters.escapeTe;
+  const G4float escapeCd = parameters.escapeTe + parameters.escapeCd;
+
+  // escape and charge statistics of the deposits
+  const G4float* edep = fEdep.data();
+  const G4float* flat = fEscapeFlat.data();
+  const G4float* gauss = fFanoGauss.data();
+  G4float* charge = fCharge.data();
+  for (size_t i = 0; i < size; ++i) {
+    G4float e = edep[i];
+    G4float escape = (flat[i] < escapeTe && e > kTeEdge) ? kTeKAlpha
+                   : (flat[i] < escapeCd && e > kCdEdge) ? kCdKAlpha : 0.f;
+    e -= escape;
+    e += std::sqrt(fano*e)*gauss[i];
+    charge[i] = std::max(e, 0.f);
+  }
+
+  // signals of the pixels of each event
+  if (parameters.cloud > 0.) {
+    Share(parameters.cloud);
+  }
+  else {
+    fSignalPixel.assign(fPixel.begin(), fPixel.end());
+    fSignal.assign(fCharge.begin(), fCharge.end());
+  }
+
+  // electronic noise, threshold
+  const size_t nbSignals = fSignal.size();
+  const G4float noise = parameters.noise;
+  const G4float* noiseGauss = fNoiseGauss.data();
+  G4float* signal = fSignal.data();
+  for (size_t k = 0; k < nbSignals; ++k) signal[k] += noise*noiseGauss[k];
+
+  const G4float threshold = parameters.threshold;
+  const G4double binWidth = emax/spectrum.size();
+  G4long nbTriggers = 0;
+  for (size_t k = 0; k < nbSignals; ++k) {
+    if (signal[k] < threshold) continue;
+    ++nbTriggers;
+    if (signal[k] < emax) ++spectrum[size_t(signal[k]/binWidth)];
+  }
+  return nbTriggers;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3Digitizer::Share(G4double cloud)
+{
+  // fractions beyond each edge of the pixel: 0 left, 1 right (crystals),
+  // 2 down, 3 up (rings)
+  const size_t size = fEdep.size();
+  const G4float scale = fPitch/(std::sqrt(2.)*cloud);
+  const G4float* u = fPositionU.data();
+  const G4float* v = fPositionV.data();
+  G4float* left = fShare[0].data();
+  G4float* right = fShare[1].data();
+  G4float* down = fShare[2].data();
+  G4float* up = fShare[3].data();
+  for (size_t i = 0; i < size; ++i) {
+    left[i]  = 0.5f*std::erfc(u[i]*scale);
+    right[i] = 0.5f*std::erfc((1.f - u[i])*scale);
+    down[i]  = 0.5f*std::erfc(v[i]*scale);
+    up[i]    = 0.5f*std::erfc((1.f - v[i])*scale);
+  }
+
+  // the deposit and its neighbours, summed per pixel of the event
+  fSignalPixel.clear();
+  fSignal.clear();
+  size_t first = 0;
+  for (size_t i = 0; i < size; ++i) {
+    if (i > 0 && fEvent[i] != fEvent[i-1]) first = fSignal.size();
+
+    G4int crystal = fPixel[i] % fNbCrystals;
+    G4int ring = fPixel[i] / fNbCrystals;
+    G4float inCrystal = 1.f - left[i] - right[i];
+    G4int pixels[5] = {
+      fPixel[i],
+      ring*fNbCrystals + (crystal + fNbCrystals - 1) % fNbCrystals,
+      ring*fNbCrystals + (crystal + 1) % fNbCrystals,
+      ring > 0 ? fPixel[i] - fNbCrystals : -1,
+      ring < fNbRings - 1 ? fPixel[i] + fNbCrystals : -1 };
+    G4float charges[5] = {
+      fCharge[i]*inCrystal*(1.f - down[i] - up[i]),
+      fCharge[i]*left[i],
+      fCharge[i]*right[i],
+      fCharge[i]*inCrystal*down[i],
+      fCharge[i]*inCrystal*up[i] };
+
+    for (G4int k = 0; k < 5; ++k) {
+      if (pixels[k] < 0 || charges[k] <= 0.f) continue;
+      size_t j = first;
+      while (j < fSignal.size() && fSignalPixel[j] != pixels[k]) ++j;
+      if (j == fSignal.size()) {
+        fSignalPixel.push_back(pixels[k]);
+        fSignal.push_back(0.f);
+      }
+      fSignal[j] += charges[k];
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,214 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3DoseGrid.cc
+/// \brief Implementation of the B3DoseGrid class
+
+#include "B3DoseGrid.hh"
+#include "B3DoseGridMessenger.hh"
+#include "B3Npy.hh"
+
+#include "G4AccumulableManager.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4VSolid.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4Material.hh"
+#include "G4Step.hh"
+#include "G4Navigator.hh"
+#include "G4TransportationManager.hh"
+#include "G4SystemOfUnits.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3DoseGrid::B3DoseGrid()
+ : fEnabled(false),
+   fBinVolume(0.),
+   fPatientRegion(0),
+   fMoRegion(0),
+   fDose("DoseGrid"),
+   fMessenger(0)
+{
+  fNbBins[0] = fNbBins[1] = 40;
+  fNbBins[2] = 100;
+
+  G4AccumulableManager::Instance()->RegisterAccumulable(&fDose);
+
+  fMessenger = new B3DoseGridMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3DoseGrid::~B3DoseGrid()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3DoseGrid::SetNbBins(G4int nx, G4int ny, G4int nz)
+{
+  fNbBins[0] = nx;
+  fNbBins[1] = ny;
+  fNbBins[2] = nz;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3DoseGrid::BeginOfRun()
+{
+  if (!fEnabled) return;
+
+  // the grid covers the patient, placed unrotated at the origin
+  G4LogicalVolume* patientLV =
+    G4LogicalVolumeStore::GetInstance()->GetVolume("PatientLV");
+  G4ThreeVector max;
+  patientLV->GetSolid()->BoundingLimits(fMin, max);
+  G4ThreeVector size = max - fMin;
+  fBinSize = G4ThreeVector(size.x()/fNbBins[0], size.y()/fNbBins[1],
+                           size.z()/fNbBins[2]);
+  fBinVolume = fBinSize.x()*fBinSize.y()*fBinSize.z();
+
+  G4RegionStore* regionStore = G4RegionStore::GetInstance();
+  fPatientRegion = regionStore->GetRegion("Patient", false);
+  fMoRegion      = regionStore->GetRegion("MoSolution", false);
+
+  fDose.SetSize(fNbBins[0]*fNbBins[1]*fNbBins[2]);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3DoseGrid::Score(const G4Step* step)
+{
+  G4double edep = step->GetTotalEnergyDeposit();
+  if (edep <= 0.) return;
+
+  const G4StepPoint* prePoint = step->GetPreStepPoint();
+  const G4Region* region =
+    prePoint->GetPhysicalVolume()->GetLogicalVolume()->GetRegion();
+  if (region != fPatientRegion && region != fMoRegion) return;
+
+  G4ThreeVector position =
+    0.5*(prePoint->GetPosition() + step->GetPostStepPoint()->GetPosition());
+  G4ThreeVector local = position - fMin;
+  G4int ix = G4int(local.x()/fBinSize.x());
+  G4int iy = G4int(local.y()/fBinSize.y());
+  G4int iz = G4int(local.z()/fBinSize.z());
+  if (ix < 0 || ix >= fNbBins[0] || iy < 0 || iy >= fNbBins[1] ||
+      iz < 0 || iz >= fNbBins[2]) return;
+
+  fDose.Score((iz*fNbBins[1] + iy)*fNbBins[0] + ix,
+              edep*step->GetTrack()->GetWeight());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B3DoseGrid::ComputeMass(G4Navigator* navigator, G4int ix, G4int iy,
+                                 G4int iz, G4int n) const
+{
+  G4double density = 0.;
+  for (G4int k = 0; k < n; ++k) {
+    for (G4int j = 0; j < n; ++j) {
+      for (G4int i = 0; i < n; ++i) {
+        G4ThreeVector point = fMin + G4ThreeVector(
+          (ix + (i + 0.5)/n)*fBinSize.x(),
+          (iy + (j + 0.5)/n)*fBinSize.y(),
+          (iz + (k + 0.5)/n)*fBinSize.z());
+        G4VPhysicalVolume* volume =
+          navigator->LocateGlobalPointAndSetup(point, 0, false, true);
+        if (!volume) continue;
+        // the parameterised volumes are given their material when located
+        G4LogicalVolume* logical = volume->GetLogicalVolume();
+        if (logical->GetRegion() != fPatientRegion &&
+            logical->GetRegion() != fMoRegion) continue;
+        density += logical->GetMaterial()->GetDensity();
+      }
+    }
+  }
+  return density/(n*n*n)*fBinVolume;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3DoseGrid::EndOfEvent()
+{
+  if (fEnabled) fDose.EndOfHistory();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3DoseGrid::Write(const G4String& fileName, G4int nofEvents) const
+{
+  size_t size = fDose.GetSize();
+  if (!fEnabled || size == 0) return;
+
+  std::vector<G4double> data(2*size);
+  fDose.GetMeanAndError(nofEvents, &data[0], &data[size]);
+
+  // energy to dose; a cell whose scored content is thinner than the
+  // lattice is sampled again, finer
+  G4Navigator navigator;
+  navigator.SetWorldVolume(G4TransportationManager::GetTransportationManager()
+                           ->GetNavigatorForTracking()->GetWorldVolume());
+  G4int nbMissed = 0;
+  for (size_t i = 0; i < size; ++i) {
+    if (data[i] == 0.) continue;
+    G4int ix = i % fNbBins[0];
+    G4int iy = (i / fNbBins[0]) % fNbBins[1];
+    G4int iz = i / (fNbBins[0]*fNbBins[1]);
+    G4double mass = ComputeMass(&navigator, ix, iy, iz, 3);
+    if (mass <= 0.) mass = ComputeMass(&navigator, ix, iy, iz, 9);
+    if (mass <= 0.) {
+      ++nbMissed;
+      data[i] = data[size + i] = 0.;
+      continue;
+    }
+    data[i] /= mass*gray;
+    data[size + i] /= mass*gray;
+  }
+  if (nbMissed > 0) {
+    G4ExceptionDescription msg;
+    msg << nbMissed << " cells of the dose grid with a deposit were found"
+        << " without mass, and left at 0.";
+    G4Exception("B3DoseGrid::Write()", "MyCode0017", JustWarning, msg);
+  }
+
+  std::vector<size_t> shape;
+  shape.push_back(2);
+  shape.push_back(fNbBins[2]);
+  shape.push_back(fNbBins[1]);
+  shape.push_back(fNbBins[0]);
+  if (B3Npy::Write(fileName, shape, &data[0])) {
+    G4cout << " Dose grid written to " << fileName << ": "
+           << fNbBins[0] << " x " << fNbBins[1] << " x " << fNbBins[2]
+           << " bins of " << fBinSize/mm << " mm from "
+           << fMin/mm << " mm" << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
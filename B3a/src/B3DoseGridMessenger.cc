@@ -0,0 +1,93 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3DoseGridMessenger.cc
+/// \brief Implementation of the B3DoseGridMessenger class
+
+#include "B3DoseGridMessenger.hh"
+#include "B3DoseGrid.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithABool.hh"
+
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3DoseGridMessenger::B3DoseGridMessenger(B3DoseGrid* doseGrid)
+ : G4UImessenger(),
+   fDoseGrid(doseGrid),
+   fDirectory(0),
+   fEnableCmd(0),
+   fNbBinsCmd(0)
+{
+  fDirectory = new G4UIdirectory("/B3/dose/");
+  fDirectory->SetGuidance("3D dose grid over the patient.");
+
+  fEnableCmd = new G4UIcmdWithABool("/B3/dose/enable",this);
+  fEnableCmd->SetGuidance("Score the dose and its error in a 3D grid.");
+  fEnableCmd->SetParameterName("flag",true);
+  fEnableCmd->SetDefaultValue(true);
+  fEnableCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fNbBinsCmd = new G4UIcommand("/B3/dose/nbBins",this);
+  fNbBinsCmd->SetGuidance("Number of bins along x, y and z.");
+  const char* axes[3] = { "nx", "ny", "nz" };
+  for (G4int i = 0; i < 3; ++i) {
+    G4UIparameter* parameter = new G4UIparameter(axes[i],'i',false);
+    parameter->SetParameterRange(G4String(axes[i]) + " > 0");
+    fNbBinsCmd->SetParameter(parameter);
+  }
+  fNbBinsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3DoseGridMessenger::~B3DoseGridMessenger()
+{
+  delete fEnableCmd;
+  delete fNbBinsCmd;
+  delete fDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3DoseGridMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if ( command == fEnableCmd ) {
+    fDoseGrid->SetEnabled(fEnableCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fNbBinsCmd ) {
+    G4int nx = 0, ny = 0, nz = 0;
+    std::istringstream is(newValue);
+    is >> nx >> ny >> nz;
+    fDoseGrid->SetNbBins(nx, ny, nz);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
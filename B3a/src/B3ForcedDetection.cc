@@ -0,0 +1,486 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3ForcedDetection.cc
+/// \brief Implementation of the B3ForcedDetection class
+
+#include "B3ForcedDetection.hh"
+#include "B3ForcedDetectionMessenger.hh"
+#include "B3DetectorConstruction.hh"
+#include "B3Npy.hh"
+
+#include "G4RunManager.hh"
+#include "G4AccumulableManager.hh"
+#include "G4TransportationManager.hh"
+#include "G4Navigator.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4PhantomParameterisation.hh"
+#include "G4AffineTransform.hh"
+#include "G4VSolid.hh"
+#include "G4Threading.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4Material.hh"
+#include "G4EmCalculator.hh"
+#include "G4EmProcessSubType.hh"
+#include "G4Gamma.hh"
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4VProcess.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <map>
+
+namespace
+{
+  // material at a point in the frame of a logical volume, found by
+  // descending the placements as G4NormalNavigation does but setting
+  // nothing up; in a phantom the voxel is given by its parameterisation,
+  // other parameterised and replicated daughters are not entered
+  const G4Material* LocateMaterial(const G4LogicalVolume* volume,
+                                   const G4ThreeVector& point)
+  {
+    for (size_t i = 0; i < volume->GetNoDaughters(); ++i) {
+      G4VPhysicalVolume* daughter = volume->GetDaughter(i);
+      if (daughter->IsParameterised()) {
+        G4PhantomParameterisation* phantom =
+          dynamic_cast<G4PhantomParameterisation*>(
+            daughter->GetParameterisation());
+        if (!phantom) continue;
+        // the voxels fill their container, in its frame
+        G4int copyNo = phantom->GetReplicaNo(point, G4ThreeVector(0., 0., 1.));
+        return phantom->ComputeMaterial(copyNo, daughter, 0);
+      }
+      if (daughter->IsReplicated()) continue;
+
+      G4AffineTransform transform(daughter->GetRotation(),
+                                  daughter->GetTranslation());
+      transform.Invert();
+      G4ThreeVector local = transform.TransformPoint(point);
+      const G4LogicalVolume* logical = daughter->GetLogicalVolume();
+      if (logical->GetSolid()->Inside(local) != kOutside) {
+        return LocateMaterial(logical, local);
+      }
+    }
+    return volume->GetMaterial();
+  }
+}
+
+G4ThreeVector B3ForcedDetection::fgMapMin;
+G4ThreeVector B3ForcedDetection::fgMapCell;
+G4int B3ForcedDetection::fgMapBins[3] = { 0, 0, 0 };
+std::vector<unsigned short> B3ForcedDetection::fgMap;
+std::vector<size_t> B3ForcedDetection::fgMapMaterials;
+size_t B3ForcedDetection::fgOutsideMaterial = 0;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ForcedDetection::B3ForcedDetection()
+ : fEnabled(false),
+   fNbBins(240),
+   fMaxEnergy(24.*keV),
+   fMapCellSize(0.5*mm),
+   fDetector(0),
+   fNbPixels(0),
+   fPixelArea(0.),
+   fCrystalThickness(0.),
+   fCrystalMaterialIndex(0),
+   fPatientRegion(0),
+   fMoRegion(0),
+   fTableStep(0.05*keV),
+   fForced("ForcedDetection"),
+   fAnalog("AnalogSpectra"),
+   fMessenger(0)
+{
+  G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
+  accumulableManager->RegisterAccumulable(&fForced);
+  accumulableManager->RegisterAccumulable(&fAnalog);
+
+  fMessenger = new B3ForcedDetectionMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ForcedDetection::~B3ForcedDetection()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ForcedDetection::BeginOfRun(G4bool tracking)
+{
+  if (!fEnabled) return;
+
+  fDetector = static_cast<const B3DetectorConstruction*>(
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  fNbPixels = fDetector->GetNbPixels();
+  fForced.SetSize(fNbPixels*fNbBins);
+  fAnalog.SetSize(fNbPixels*fNbBins);
+
+  // one map for all the threads
+  if (G4Threading::IsMasterThread()) BuildMaterialMap();
+
+  // the master only merges and writes
+  if (!tracking) return;
+
+  // pixel geometry
+  fPixelEntrance.resize(fNbPixels);
+  fPixelDirection.resize(fNbPixels);
+  fPixelActive.resize(fNbPixels);
+  G4int nbCrystals = fDetector->GetNbCrystals();
+  for (G4int pixel = 0; pixel < fNbPixels; ++pixel) {
+    fPixelEntrance[pixel]  = fDetector->GetPixelEntrance(pixel);
+    fPixelDirection[pixel] = fDetector->GetPixelDirection(pixel);
+    fPixelActive[pixel] =
+      !fDetector->IsBeamHole(pixel/nbCrystals, pixel%nbCrystals);
+  }
+  G4double gap = fDetector->GetGap();
+  fPixelArea = (fDetector->GetCrystalDX() - gap)*(fDetector->GetCrystalDY() - gap);
+  fCrystalThickness = fDetector->GetCrystalDZ();
+  fCrystalMaterialIndex = fDetector->GetCrystalMaterial()->GetIndex();
+
+  G4RegionStore* regionStore = G4RegionStore::GetInstance();
+  fPatientRegion = regionStore->GetRegion("Patient", false);
+  fMoRegion      = regionStore->GetRegion("MoSolution", false);
+
+  BuildAttenuationTable();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ForcedDetection::BuildMaterialMap()
+{
+  // the map covers the patient, placed unrotated at the origin
+  G4LogicalVolume* patientLV =
+    G4LogicalVolumeStore::GetInstance()->GetVolume("PatientLV");
+  G4ThreeVector max;
+  patientLV->GetSolid()->BoundingLimits(fgMapMin, max);
+  G4ThreeVector size = max - fgMapMin;
+  for (G4int k = 0; k < 3; ++k) {
+    fgMapBins[k] = std::max(G4int(std::ceil(size[k]/fMapCellSize)), 1);
+  }
+  fgMapCell = G4ThreeVector(size.x()/fgMapBins[0], size.y()/fgMapBins[1],
+                            size.z()/fgMapBins[2]);
+
+  const G4LogicalVolume* worldLV =
+    G4TransportationManager::GetTransportationManager()
+      ->GetNavigatorForTracking()->GetWorldVolume()->GetLogicalVolume();
+  fgOutsideMaterial = worldLV->GetMaterial()->GetIndex();
+
+  // material of the centre of each cell
+  std::map<size_t, unsigned short> indices;
+  fgMapMaterials.clear();
+  fgMap.resize(size_t(fgMapBins[0])*fgMapBins[1]*fgMapBins[2]);
+  size_t cell = 0;
+  for (G4int iz = 0; iz < fgMapBins[2]; ++iz) {
+    for (G4int iy = 0; iy < fgMapBins[1]; ++iy) {
+      for (G4int ix = 0; ix < fgMapBins[0]; ++ix, ++cell) {
+        G4ThreeVector centre = fgMapMin
+          + G4ThreeVector((ix + 0.5)*fgMapCell.x(), (iy + 0.5)*fgMapCell.y(),
+                          (iz + 0.5)*fgMapCell.z());
+        size_t material = LocateMaterial(worldLV, centre)->GetIndex();
+        std::map<size_t, unsigned short>::iterator it =
+          indices.find(material);
+        if (it == indices.end()) {
+          it = indices.insert(std::make_pair(
+                 material, (unsigned short)fgMapMaterials.size())).first;
+          fgMapMaterials.push_back(material);
+        }
+        fgMap[cell] = it->second;
+      }
+    }
+  }
+
+  G4cout << " Forced detection: attenuation map of " << fgMapBins[0]
+         << " x " << fgMapBins[1] << " x " << fgMapBins[2] << " cells, "
+         << fgMapMaterials.size() << " materials" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ForcedDetection::BuildAttenuationTable()
+{
+  const G4MaterialTable* materials = G4Material::GetMaterialTable();
+  G4int nbPoints = G4int(1.2*fMaxEnergy/fTableStep) + 2;
+  fAttenuation.assign(materials->size(), std::vector<G4double>());
+
+  // only the materials crossed by the rays
+  std::vector<size_t> needed(fgMapMaterials);
+  needed.push_back(fgOutsideMaterial);
+  needed.push_back(fCrystalMaterialIndex);
+
+  G4EmCalculator calculator;
+  calculator.SetVerbose(0);
+  const G4ParticleDefinition* gamma = G4Gamma::Gamma();
+  const char* processes[4] = { "phot", "compt", "Rayl", "conv" };
+
+  for (size_t k = 0; k < needed.size(); ++k) {
+    size_t m = needed[k];
+    std::vector<G4double>& mu = fAttenuation[m];
+    if (!mu.empty()) continue;
+    mu.assign(nbPoints, 0.);
+    for (G4int i = 1; i < nbPoints; ++i) {
+      for (G4int p = 0; p < 4; ++p) {
+        mu[i] += calculator.ComputeCrossSectionPerVolume(
+                   i*fTableStep, gamma, processes[p], (*materials)[m]);
+      }
+    }
+    mu[0] = mu[1];
+  }
+
+  const G4Material* crystal = (*materials)[fCrystalMaterialIndex];
+  const std::vector<G4double>& muCrystal = fAttenuation[fCrystalMaterialIndex];
+  fPhotoFraction.assign(nbPoints, 0.);
+  for (G4int i = 1; i < nbPoints; ++i) {
+    G4double muPhot = calculator.ComputeCrossSectionPerVolume(
+                        i*fTableStep, gamma, "phot", crystal);
+    if (muCrystal[i] > 0.) fPhotoFraction[i] = muPhot/muCrystal[i];
+  }
+  fPhotoFraction[0] = fPhotoFraction[1];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B3ForcedDetection::Attenuation(size_t materialIndex,
+                                        G4double energy) const
+{
+  const std::vector<G4double>& mu = fAttenuation[materialIndex];
+  G4double x = energy/fTableStep;
+  size_t i = size_t(x);
+  if (i + 1 >= mu.size()) return mu.back();
+  G4double f = x - i;
+  return (1. - f)*mu[i] + f*mu[i+1];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B3ForcedDetection::Transmission(const G4ThreeVector& start,
+                                         const G4ThreeVector& direction,
+                                         G4double distance,
+                                         G4double energy) const
+{
+  // part of the ray in the map
+  G4double tIn = 0., tOut = distance;
+  for (G4int k = 0; k < 3; ++k) {
+    G4double low  = fgMapMin[k];
+    G4double high = low + fgMapBins[k]*fgMapCell[k];
+    if (direction[k] == 0.) {
+      if (start[k] < low || start[k] > high) tOut = -1.;
+      continue;
+    }
+    G4double t0 = (low  - start[k])/direction[k];
+    G4double t1 = (high - start[k])/direction[k];
+    if (t0 > t1) std::swap(t0, t1);
+    tIn  = std::max(tIn, t0);
+    tOut = std::min(tOut, t1);
+  }
+
+  // energy interpolation, the same in all the cells
+  G4double x = energy/fTableStep;
+  size_t i = std::min(size_t(x), fPhotoFraction.size() - 2);
+  G4double f = std::min(x - i, 1.);
+
+  G4double opticalDepth = 0.;
+  G4double inMap = 0.;
+  if (tIn < tOut) {
+    inMap = tOut - tIn;
+
+    // cell of the entry point, distance to its next wall along each axis
+    G4ThreeVector entry = start + tIn*direction;
+    G4int cell[3], step[3];
+    G4double tNext[3], tDelta[3];
+    for (G4int k = 0; k < 3; ++k) {
+      cell[k] = G4int((entry[k] - fgMapMin[k])/fgMapCell[k]);
+      cell[k] = std::min(std::max(cell[k], 0), fgMapBins[k] - 1);
+      G4double wall = fgMapMin[k] + cell[k]*fgMapCell[k];
+      if (direction[k] > 0.) {
+        step[k] = 1;
+        tNext[k] = tIn + (wall + fgMapCell[k] - entry[k])/direction[k];
+        tDelta[k] = fgMapCell[k]/direction[k];
+      }
+      else if (direction[k] < 0.) {
+        step[k] = -1;
+        tNext[k] = tIn + (wall - entry[k])/direction[k];
+        tDelta[k] = -fgMapCell[k]/direction[k];
+      }
+      else {
+        step[k] = 0;
+        tNext[k] = DBL_MAX;
+        tDelta[k] = DBL_MAX;
+      }
+    }
+
+    G4double t = tIn;
+    while (t < tOut) {
+      G4int k = tNext[0] < tNext[1] ? (tNext[0] < tNext[2] ? 0 : 2)
+                                    : (tNext[1] < tNext[2] ? 1 : 2);
+      G4double tEnd = std::min(tNext[k], tOut);
+      size_t index = (size_t(cell[2])*fgMapBins[1] + cell[1])*fgMapBins[0]
+                   + cell[0];
+      const std::vector<G4double>& mu =
+        fAttenuation[fgMapMaterials[fgMap[index]]];
+      opticalDepth += (tEnd - t)*((1. - f)*mu[i] + f*mu[i+1]);
+      t = tEnd;
+      cell[k] += step[k];
+      if (cell[k] < 0 || cell[k] >= fgMapBins[k]) break;
+      tNext[k] += tDelta[k];
+    }
+  }
+
+  const std::vector<G4double>& mu = fAttenuation[fgOutsideMaterial];
+  opticalDepth += (distance - inMap)*((1. - f)*mu[i] + f*mu[i+1]);
+  return std::exp(-opticalDepth);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ForcedDetection::ProcessStep(const G4Step* step)
+{
+  const G4StepPoint* prePoint = step->GetPreStepPoint();
+  const G4Region* region =
+    prePoint->GetPhysicalVolume()->GetLogicalVolume()->GetRegion();
+  if (region != fPatientRegion && region != fMoRegion) return;
+
+  // Compton scattering vertex
+  const G4Track* track = step->GetTrack();
+  const G4VProcess* process = step->GetPostStepPoint()->GetProcessDefinedStep();
+  if (track->GetDefinition() == G4Gamma::Gamma() && process &&
+      process->GetProcessSubType() == fComptonScattering) {
+    G4ThreeVector incident = prePoint->GetMomentumDirection();
+    ScorePixels(step->GetPostStepPoint()->GetPosition(),
+                prePoint->GetKineticEnergy(), track->GetWeight(), &incident);
+  }
+
+  // emission vertices of secondary photons
+  const std::vector<const G4Track*>* secondaries =
+    step->GetSecondaryInCurrentStep();
+  for (size_t i = 0; i < secondaries->size(); ++i) {
+    const G4Track* secondary = (*secondaries)[i];
+    if (secondary->GetDefinition() != G4Gamma::Gamma()) continue;
+    const G4VProcess* creator = secondary->GetCreatorProcess();
+    if (creator && creator->GetProcessSubType() == fBremsstrahlung) continue;
+    ScorePixels(secondary->GetPosition(), secondary->GetKineticEnergy(),
+                secondary->GetWeight(), 0);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ForcedDetection::ScorePixels(const G4ThreeVector& vertex,
+                                    G4double energy, G4double weight,
+                                    const G4ThreeVector* incident)
+{
+  // Klein-Nishina total cross section, in units of r_e^2
+  G4double k = energy/electron_mass_c2;
+  G4double sigma = 0.;
+  if (incident) {
+    G4double l = std::log(1. + 2.*k);
+    sigma = twopi*( (1. + k)/(k*k)*(2.*(1. + k)/(1. + 2.*k) - l/k)
+                  + 0.5*l/k - (1. + 3.*k)/((1. + 2.*k)*(1. + 2.*k)) );
+  }
+
+  for (G4int pixel = 0; pixel < fNbPixels; ++pixel) {
+    if (!fPixelActive[pixel]) continue;
+
+    G4ThreeVector path = fPixelEntrance[pixel] - vertex;
+    G4double distance2 = path.mag2();
+    G4double distance = std::sqrt(distance2);
+    G4ThreeVector direction = path/distance;
+    G4double cosIn = direction.dot(fPixelDirection[pixel]);
+    if (cosIn <= 0.) continue;
+
+    // probability per unit solid angle and energy towards the pixel
+    G4double e = energy;
+    G4double density = 1./(4.*pi);
+    if (incident) {
+      G4double cosT = incident->dot(direction);
+      G4double ratio = 1./(1. + k*(1. - cosT));
+      e = ratio*energy;
+      density = 0.5*ratio*ratio*(ratio + 1./ratio - (1. - cosT*cosT))/sigma;
+    }
+    if (e >= fMaxEnergy) continue;
+
+    // full-energy absorption, deposited in the bin of e
+    G4double solidAngle = fPixelArea*cosIn/distance2;
+    size_t i = size_t(e/fTableStep);
+    G4double efficiency = fPhotoFraction[i]*(1. - std::exp(
+      -Attenuation(fCrystalMaterialIndex, e)*fCrystalThickness/cosIn));
+    G4double transmission = Transmission(vertex, direction, distance, e);
+
+    G4int bin = G4int(e/fMaxEnergy*fNbBins);
+    fForced.Score(pixel*fNbBins + bin,
+                  weight*density*solidAngle*transmission*efficiency);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ForcedDetection::ScoreAnalog(G4int pixel, G4double edep)
+{
+  if (!fEnabled) return;
+  G4int bin = G4int(edep/fMaxEnergy*fNbBins);
+  if (bin < fNbBins) fAnalog.Score(pixel*fNbBins + bin, 1.);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ForcedDetection::EndOfEvent()
+{
+  if (!fEnabled) return;
+  fForced.EndOfHistory();
+  fAnalog.EndOfHistory();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ForcedDetection::Write(const G4String& fileName, G4int nofEvents) const
+{
+  size_t size = fForced.GetSize();
+  if (!fEnabled || size == 0) return;
+
+  // forced mean, forced error, analog mean, analog error per primary
+  std::vector<G4double> data(4*size);
+  fForced.GetMeanAndError(nofEvents, &data[0], &data[size]);
+  fAnalog.GetMeanAndError(nofEvents, &data[2*size], &data[3*size]);
+
+  std::vector<size_t> shape;
+  shape.push_back(4);
+  shape.push_back(fDetector->GetNbRings());
+  shape.push_back(fDetector->GetNbCrystals());
+  shape.push_back(fNbBins);
+  if (B3Npy::Write(fileName, shape, &data[0])) {
+    G4cout << " Forced detection spectra written to " << fileName << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
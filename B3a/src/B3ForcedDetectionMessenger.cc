@@ -0,0 +1,114 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3ForcedDetectionMessenger.cc
+/// \brief Implementation of the B3ForcedDetectionMessenger class
+
+#include "B3ForcedDetectionMessenger.hh"
+#include "B3ForcedDetection.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ForcedDetectionMessenger::B3ForcedDetectionMessenger(
+                                    B3ForcedDetection* forcedDetection)
+ : G4UImessenger(),
+   fForcedDetection(forcedDetection),
+   fDirectory(0),
+   fEnableCmd(0),
+   fNbBinsCmd(0),
+   fMaxEnergyCmd(0),
+   fMapCellSizeCmd(0)
+{
+  fDirectory = new G4UIdirectory("/B3/fd/");
+  fDirectory->SetGuidance("Forced detection of photons in the pixels.");
+
+  fEnableCmd = new G4UIcmdWithABool("/B3/fd/enable",this);
+  fEnableCmd->SetGuidance("Score the next-event estimator at each photon");
+  fEnableCmd->SetGuidance("emission or Compton vertex in the patient.");
+  fEnableCmd->SetParameterName("flag",true);
+  fEnableCmd->SetDefaultValue(true);
+  fEnableCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fNbBinsCmd = new G4UIcmdWithAnInteger("/B3/fd/nbBins",this);
+  fNbBinsCmd->SetGuidance("Number of energy bins of the pixel spectra.");
+  fNbBinsCmd->SetParameterName("nbBins",false);
+  fNbBinsCmd->SetRange("nbBins>0");
+  fNbBinsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fMaxEnergyCmd = new G4UIcmdWithADoubleAndUnit("/B3/fd/maxEnergy",this);
+  fMaxEnergyCmd->SetGuidance("Upper edge of the pixel spectra.");
+  fMaxEnergyCmd->SetParameterName("emax",false);
+  fMaxEnergyCmd->SetRange("emax>0.");
+  fMaxEnergyCmd->SetUnitCategory("Energy");
+  fMaxEnergyCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fMapCellSizeCmd = new G4UIcmdWithADoubleAndUnit("/B3/fd/mapCellSize",this);
+  fMapCellSizeCmd->SetGuidance("Cell size of the attenuation map of the patient.");
+  fMapCellSizeCmd->SetParameterName("size",false);
+  fMapCellSizeCmd->SetRange("size>0.");
+  fMapCellSizeCmd->SetUnitCategory("Length");
+  fMapCellSizeCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  // the map is built by the master
+  fMapCellSizeCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ForcedDetectionMessenger::~B3ForcedDetectionMessenger()
+{
+  delete fEnableCmd;
+  delete fNbBinsCmd;
+  delete fMaxEnergyCmd;
+  delete fMapCellSizeCmd;
+  delete fDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ForcedDetectionMessenger::SetNewValue(G4UIcommand* command,
+                                             G4String newValue)
+{
+  if ( command == fEnableCmd ) {
+    fForcedDetection->SetEnabled(fEnableCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fNbBinsCmd ) {
+    fForcedDetection->SetNbBins(fNbBinsCmd->GetNewIntValue(newValue));
+  }
+  else if ( command == fMaxEnergyCmd ) {
+    fForcedDetection->SetMaxEnergy(fMaxEnergyCmd->GetNewDoubleValue(newValue));
+  }
+  else if ( command == fMapCellSizeCmd ) {
+    fForcedDetection->SetMapCellSize(
+      fMapCellSizeCmd->GetNewDoubleValue(newValue));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,119 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3GeometrySnapshot.cc
+/// \brief Implementation of the B3GeometrySnapshot class
+
+#include "B3GeometrySnapshot.hh"
+#include "B3DetectorConstruction.hh"
+#include "B3VoxelPhantom.hh"
+
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+
+#ifdef B3_USE_GDML
+#include "G4GDMLParser.hh"
+#endif
+
+#include <cstdio>
+#include <sstream>
+
+namespace
+{
+#ifdef B3_USE_GDML
+  // auxiliary types of the world volume
+  const char* const kNbCrystals  = "B3nbCrystals";
+  const char* const kNbRings     = "B3nbRings";
+  const char* const kCrystalDX   = "B3crystalDX";
+  const char* const kCrystalDY   = "B3crystalDY";
+  const char* const kCrystalDZ   = "B3crystalDZ";
+  const char* const kGap         = "B3gap";
+  const char* const kMoMass      = "B3moMass";
+  const char* const kVoxels      = "B3voxelPhantom";
+
+  void AddParameter(G4GDMLParser& parser, const G4LogicalVolume* volume,
+                    const G4String& type, G4double value,
+                    const G4String& unit = "")
+  {
+    std::ostringstream os;
+    os.precision(17);
+    os << (unit.empty() ? value : value/G4UnitDefinition::GetValueOf(unit));
+    G4GDMLAuxStructType aux = { type, os.str(), unit, 0 };
+    parser.AddVolumeAuxiliary(aux, volume);
+  }
+#else
+  void NoGdml(const char* where)
+  {
+    G4Exception(where, "MyCode0015", FatalException,
+                "Geant4 was built without GDML: no geometry snapshot.");
+  }
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3GeometrySnapshot::Write(const G4String& fileName,
+                               G4VPhysicalVolume* world,
+                               const B3DetectorConstruction* detector)
+{
+#ifdef B3_USE_GDML
+  G4GDMLParser parser;
+  const G4LogicalVolume* worldLV = world->GetLogicalVolume();
+  AddParameter(parser, worldLV, kNbCrystals, detector->GetNbCrystals());
+  AddParameter(parser, worldLV, kNbRings, detector->GetNbRings());
+  AddParameter(parser, worldLV, kCrystalDX, detector->GetCrystalDX(), "mm");
+  AddParameter(parser, worldLV, kCrystalDY, detector->GetCrystalDY(), "mm");
+  AddParameter(parser, worldLV, kCrystalDZ, detector->GetCrystalDZ(), "mm");
+  AddParameter(parser, worldLV, kGap, detector->GetGap(), "mm");
+  AddParameter(parser, worldLV, kMoMass, detector->GetMoMass(), "mg");
+  G4bool voxels = detector->GetVoxelPhantom()->IsDefined();
+  AddParameter(parser, worldLV, kVoxels, voxels);
+
+  // the voxels are taken out of their container while it is written
+  G4VPhysicalVolume* physVoxels = 0;
+  if (voxels) {
+    physVoxels = G4PhysicalVolumeStore::GetInstance()->GetVolume("Voxels");
+    physVoxels->GetMotherLogical()->RemoveDaughter(physVoxels);
+  }
+
+  // the GDML writer does not overwrite a file: the snapshot of a rebuilt
+  // geometry replaces the previous one
+  std::remove(fileName.c_str());
+  parser.Write(fileName, world, true);
+
+  if (physVoxels) physVoxels->GetMotherLogical()->AddDaughter(physVoxels);
+
+  G4cout << "\nGeometry snapshot written to " << fileName << G4endl;
+#else
+  (void)fileName; (void)world; (void)detector;
+  NoGdml("B3GeometrySnapshot::Write()");
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
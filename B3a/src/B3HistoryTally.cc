@@ -0,0 +1,146 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3HistoryTally.cc
+/// \brief Implementation of the B3HistoryTally class
+
+#include "B3HistoryTally.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <istream>
+#include <ostream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3HistoryTally::B3HistoryTally(const G4String& name)
+ : G4VAccumulable(name),
+   fSum(), fSum2(), fHistory(), fTouched()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3HistoryTally::~B3HistoryTally()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3HistoryTally::SetSize(size_t size)
+{
+  if (size != fSum.size()) {
+    fSum.assign(size, 0.);
+    fSum2.assign(size, 0.);
+    fHistory.assign(size, 0.);
+    fTouched.clear();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3HistoryTally::EndOfHistory()
+{
+  for (size_t i = 0; i < fTouched.size(); ++i) {
+    size_t index = fTouched[i];
+    G4double x = fHistory[index];
+    fSum[index]  += x;
+    fSum2[index] += x*x;
+    fHistory[index] = 0.;
+  }
+  fTouched.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3HistoryTally::Merge(const G4VAccumulable& other)
+{
+  const B3HistoryTally& tally = static_cast<const B3HistoryTally&>(other);
+  if (tally.fSum.empty()) return;
+
+  if (fSum.size() != tally.fSum.size()) SetSize(tally.fSum.size());
+  for (size_t i = 0; i < fSum.size(); ++i) {
+    fSum[i]  += tally.fSum[i];
+    fSum2[i] += tally.fSum2[i];
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3HistoryTally::Reset()
+{
+  std::fill(fSum.begin(), fSum.end(), 0.);
+  std::fill(fSum2.begin(), fSum2.end(), 0.);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3HistoryTally::GetMeanAndError(G4int nofHistories,
+                                     G4double* mean, G4double* error) const
+{
+  G4double n = nofHistories;
+  for (size_t i = 0; i < fSum.size(); ++i) {
+    mean[i] = error[i] = 0.;
+    if (nofHistories < 1) continue;
+    G4double m = fSum[i]/n;
+    mean[i] = m;
+    if (nofHistories < 2) continue;
+    G4double variance = (fSum2[i]/n - m*m)/(n - 1.);
+    error[i] = (variance > 0.) ? std::sqrt(variance) : 0.;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3HistoryTally::Save(std::ostream& output) const
+{
+  G4long size = fSum.size();
+  output.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  if (size == 0) return;
+  output.write(reinterpret_cast<const char*>(&fSum[0]), size*sizeof(G4double));
+  output.write(reinterpret_cast<const char*>(&fSum2[0]), size*sizeof(G4double));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3HistoryTally::Restore(std::istream& input)
+{
+  G4long size = 0;
+  if (!input.read(reinterpret_cast<char*>(&size), sizeof(size))) return false;
+  if (size == 0) return true;
+  if (fSum.empty()) SetSize(size);
+  if (size_t(size) != fSum.size()) return false;
+
+  std::vector<G4double> sum(size), sum2(size);
+  input.read(reinterpret_cast<char*>(&sum[0]), size*sizeof(G4double));
+  input.read(reinterpret_cast<char*>(&sum2[0]), size*sizeof(G4double));
+  if (!input) return false;
+  for (size_t i = 0; i < fSum.size(); ++i) {
+    fSum[i]  += sum[i];
+    fSum2[i] += sum2[i];
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
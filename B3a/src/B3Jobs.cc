@@ -0,0 +1,236 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3Jobs.cc
+/// \brief Implementation of the B3Jobs class
+
+#include "B3Jobs.hh"
+#include "B3NpyMerge.hh"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <dirent.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+  G4bool EndsWith(const std::string& text, const std::string& end)
+  {
+    return text.size() >= end.size() &&
+           text.compare(text.size() - end.size(), end.size(), end) == 0;
+  }
+
+  // "_run<N>" of a suffix "_run<N>_...", empty for the first run
+  std::string RunTag(const std::string& suffix)
+  {
+    if (suffix.compare(0, 4, "_run") != 0) return "";
+    size_t end = suffix.find('_', 4);
+    if (end == std::string::npos || end == 4 ||
+        suffix.find_first_not_of("0123456789", 4) != end) return "";
+    return suffix.substr(0, end);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3Jobs::B3Jobs(G4int nofJobs, const G4String& outputName, G4int nofEvents)
+ : fNofJobs(nofJobs),
+   fOutputName(outputName),
+   fNofEvents(nofEvents),
+   fNofCpus(0),
+   fSuccessful(false)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3Jobs::~B3Jobs()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int B3Jobs::GetNofEvents(G4int job) const
+{
+  return fNofEvents/fNofJobs + (job < fNofEvents % fNofJobs ? 1 : 0);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String B3Jobs::GetOutputName(G4int job) const
+{
+  std::ostringstream name;
+  name << fOutputName << "_job" << job;
+  return name.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int B3Jobs::Fork()
+{
+  auto start = std::chrono::steady_clock::now();
+  std::cout.flush();
+  std::cerr.flush();
+
+  std::vector<pid_t> pids(fNofJobs, -1);
+  for (G4int job = 0; job < fNofJobs; ++job) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      BindCpus(job);
+      G4String log = GetOutputName(job) + ".log";
+      if (!std::freopen(log.c_str(), "w", stdout) ||
+          !std::freopen(log.c_str(), "a", stderr)) {
+        std::cerr << "Cannot write " << log << std::endl;
+      }
+      return job;
+    }
+    if (pid < 0) {
+      G4cerr << "Cannot start job " << job << G4endl;
+      break;
+    }
+    pids[job] = pid;
+    G4cout << "### Job " << job << " (pid " << pid << "): "
+           << GetNofEvents(job) << " events, log " << GetOutputName(job)
+           << ".log" << G4endl;
+  }
+
+  fSuccessful = true;
+  for (G4int job = 0; job < fNofJobs; ++job) {
+    if (pids[job] < 0) {
+      fSuccessful = false;
+      continue;
+    }
+    int status = 0;
+    waitpid(pids[job], &status, 0);
+    std::chrono::duration<G4double> elapsed =
+      std::chrono::steady_clock::now() - start;
+    G4bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    G4cout << "### Job " << job << (ok ? " done" : " FAILED")
+           << " after " << elapsed.count() << " s" << G4endl;
+    fSuccessful = fSuccessful && ok;
+  }
+
+  if (fSuccessful) fSuccessful = Merge();
+  return -1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3Jobs::BindCpus(G4int job)
+{
+#ifdef __linux__
+  // a contiguous slice of the CPUs of the parent: the CPUs of a socket
+  // are numbered contiguously on most NUMA nodes
+  cpu_set_t available;
+  CPU_ZERO(&available);
+  if (sched_getaffinity(0, sizeof(available), &available) != 0) return;
+  std::vector<G4int> cpus;
+  for (G4int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &available)) cpus.push_back(cpu);
+  }
+  size_t first = cpus.size()*job/fNofJobs;
+  size_t last  = cpus.size()*(job + 1)/fNofJobs;
+  if (first == last) return;
+
+  cpu_set_t slice;
+  CPU_ZERO(&slice);
+  for (size_t i = first; i < last; ++i) CPU_SET(cpus[i], &slice);
+  if (sched_setaffinity(0, sizeof(slice), &slice) == 0) {
+    fNofCpus = last - first;
+  }
+#else
+  (void)job;
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3Jobs::Merge() const
+{
+  // the .npy files of job 0 name the outputs to merge
+  G4String directory = ".";
+  G4String base = GetOutputName(0);
+  size_t slash = base.rfind('/');
+  if (slash != std::string::npos) {
+    directory = base.substr(0, slash + 1);
+    base = base.substr(slash + 1);
+  }
+  std::vector<G4String> suffixes;
+  DIR* dir = opendir(directory.c_str());
+  if (dir) {
+    while (dirent* entry = readdir(dir)) {
+      std::string name = entry->d_name;
+      if (name.compare(0, base.size() + 1, base + "_") == 0 &&
+          EndsWith(name, ".npy")) suffixes.push_back(name.substr(base.size()));
+    }
+    closedir(dir);
+  }
+
+  G4bool ok = true;
+  for (size_t i = 0; i < suffixes.size(); ++i) {
+    std::vector<G4String> inputs;
+    for (G4int job = 0; job < fNofJobs; ++job) {
+      inputs.push_back(GetOutputName(job) + suffixes[i]);
+    }
+    G4String output = fOutputName + suffixes[i];
+
+    // arrays of mean and error planes per event, weighted with the events
+    // each job did, which an auto-stop or a resume may change
+    G4bool average = EndsWith(suffixes[i], "_dose.npy") ||
+                     EndsWith(suffixes[i], "_fd.npy");
+    std::vector<G4double> nofEvents;
+    for (G4int job = 0; average && job < fNofJobs; ++job) {
+      G4String fileName = GetOutputName(job) + RunTag(suffixes[i]) + ".events";
+      std::ifstream file(fileName.c_str());
+      G4double events = 0.;
+      if (!(file >> events)) {
+        G4cerr << "### Cannot read the number of events in " << fileName
+               << ", " << output << " not merged" << G4endl;
+        break;
+      }
+      nofEvents.push_back(events);
+    }
+    if (average && nofEvents.size() != inputs.size()) {
+      ok = false;
+      continue;
+    }
+    G4bool merged = average ? B3NpyMerge::Average(output, inputs, nofEvents)
+                            : B3NpyMerge::Sum(output, inputs);
+    if (merged) {
+      G4cout << "### " << fNofJobs << " jobs "
+             << (average ? "averaged" : "summed") << " into " << output
+             << G4endl;
+    }
+    ok = ok && merged;
+  }
+  return ok;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
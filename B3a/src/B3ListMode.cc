@@ -0,0 +1,225 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3ListMode.cc
+/// \brief Implementation of the B3ListMode class
+
+#include "B3ListMode.hh"
+#include "B3ListModeMessenger.hh"
+
+#include <chrono>
+#include <cstdint>
+
+#ifdef B3_USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace
+{
+  // chunks in flight between the tracking thread and the writer
+  const size_t kQueueCapacity = 64;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ListMode::B3ListMode()
+ : fEnabled(false),
+   fCompression(1),
+   fChunkSize(65536),
+   fCurrent(0),
+   fNbRecords(0),
+   fCompressed(false),
+   fFull(kQueueCapacity),
+   fFree(kQueueCapacity),
+   fStop(false),
+   fNbBytes(0),
+   fMessenger(0)
+{
+  static_assert(sizeof(B3ListModeRecord) == 20,
+                "list-mode records must be 20 bytes");
+  fMessenger = new B3ListModeMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ListMode::~B3ListMode()
+{
+  EndOfRun();
+  for (size_t i = 0; i < fChunks.size(); ++i) delete fChunks[i];
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ListMode::BeginOfRun(const G4String& fileName)
+{
+  if (!fEnabled) return;
+
+  fOutput.open(fileName, std::ios::binary);
+  if (!fOutput) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open " << fileName << " for writing.";
+    G4Exception("B3ListMode::BeginOfRun()", "MyCode0006", JustWarning, msg);
+    return;
+  }
+
+#ifdef B3_USE_ZLIB
+  fCompressed = fCompression > 0;
+#else
+  if (fCompression > 0) {
+    G4Exception("B3ListMode::BeginOfRun()", "MyCode0006", JustWarning,
+                "Built without zlib: the list-mode output is not compressed.");
+  }
+  fCompressed = false;
+#endif
+
+  const uint32_t header[3] =
+    { 1, uint32_t(sizeof(B3ListModeRecord)), uint32_t(fCompressed ? 1 : 0) };
+  fOutput.write("B3LM", 4);
+  fOutput.write(reinterpret_cast<const char*>(header), sizeof(header));
+  fNbBytes = 4 + sizeof(header);
+  fNbRecords = 0;
+
+  if (!fFree.Pop(fCurrent)) {
+    fCurrent = new Chunk();
+    fChunks.push_back(fCurrent);
+  }
+  fCurrent->clear();
+  fCurrent->reserve(fChunkSize);
+
+  fStop = false;
+  fWriter = std::thread(&B3ListMode::WriterLoop, this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ListMode::Submit()
+{
+  fNbRecords += fCurrent->size();
+  fBacklog.push_back(fCurrent);
+  while (!fBacklog.empty() && fFull.Push(fBacklog.front())) {
+    fBacklog.pop_front();
+  }
+  fWakeUp.notify_one();
+
+  // reuse a written chunk, or grow the pool if the writer is behind
+  if (!fFree.Pop(fCurrent)) {
+    fCurrent = new Chunk();
+    fChunks.push_back(fCurrent);
+  }
+  fCurrent->clear();
+  fCurrent->reserve(fChunkSize);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ListMode::EndOfRun()
+{
+  if (!fCurrent) return;
+
+  // hand over everything left, waiting for the writer is fine here
+  fNbRecords += fCurrent->size();
+  fBacklog.push_back(fCurrent);
+  fCurrent = 0;
+  while (!fBacklog.empty()) {
+    if (fFull.Push(fBacklog.front())) {
+      fBacklog.pop_front();
+    }
+    else {
+      fWakeUp.notify_one();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  fStop = true;
+  fWakeUp.notify_one();
+  fWriter.join();
+  fOutput.close();
+
+  G4cout << " List mode: " << fNbRecords << " records, "
+         << fNbBytes << " bytes written" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ListMode::WriterLoop()
+{
+  Chunk* chunk = 0;
+  while (true) {
+    if (fFull.Pop(chunk)) {
+      WriteChunk(*chunk);
+      // a chunk the free queue cannot take stays in fChunks until deleted
+      fFree.Push(chunk);
+      continue;
+    }
+    if (fStop) {
+      // the last chunks were queued before the stop flag
+      while (fFull.Pop(chunk)) {
+        WriteChunk(*chunk);
+        fFree.Push(chunk);
+      }
+      return;
+    }
+    std::unique_lock<std::mutex> lock(fMutex);
+    fWakeUp.wait_for(lock, std::chrono::milliseconds(10));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ListMode::WriteChunk(const Chunk& chunk)
+{
+  if (chunk.empty()) return;
+
+  const char* data = reinterpret_cast<const char*>(&chunk[0]);
+  size_t nbBytes = chunk.size()*sizeof(B3ListModeRecord);
+#ifdef B3_USE_ZLIB
+  if (fCompressed) {
+    uLongf length = compressBound(nbBytes);
+    fBuffer.resize(length);
+    int status =
+      compress2(reinterpret_cast<Bytef*>(&fBuffer[0]), &length,
+                reinterpret_cast<const Bytef*>(data), nbBytes, fCompression);
+    if (status != Z_OK) {
+      // the chunk is dropped rather than written corrupted
+      G4ExceptionDescription msg;
+      msg << "zlib error " << status << ": " << chunk.size()
+          << " list-mode records are not written.";
+      G4Exception("B3ListMode::WriteChunk()", "MyCode0006", JustWarning, msg);
+      return;
+    }
+    data = &fBuffer[0];
+    nbBytes = length;
+  }
+#endif
+
+  const uint32_t header[2] = { uint32_t(chunk.size()), uint32_t(nbBytes) };
+  fOutput.write(reinterpret_cast<const char*>(header), sizeof(header));
+  fOutput.write(data, nbBytes);
+  fNbBytes += sizeof(header) + nbBytes;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,94 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3ListModeMessenger.cc
+/// \brief Implementation of the B3ListModeMessenger class
+
+#include "B3ListModeMessenger.hh"
+#include "B3ListMode.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ListModeMessenger::B3ListModeMessenger(B3ListMode* listMode)
+ : G4UImessenger(),
+   fListMode(listMode),
+   fDirectory(0),
+   fEnableCmd(0),
+   fCompressionCmd(0),
+   fChunkSizeCmd(0)
+{
+  fDirectory = new G4UIdirectory("/B3/listMode/");
+  fDirectory->SetGuidance("List-mode output of the pixel deposits.");
+
+  fEnableCmd = new G4UIcmdWithABool("/B3/listMode/enable",this);
+  fEnableCmd->SetGuidance("Write one record per pixel deposit and event.");
+  fEnableCmd->SetParameterName("flag",true);
+  fEnableCmd->SetDefaultValue(true);
+  fEnableCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fCompressionCmd = new G4UIcmdWithAnInteger("/B3/listMode/compression",this);
+  fCompressionCmd->SetGuidance("zlib level of the chunks, 0 for raw records.");
+  fCompressionCmd->SetParameterName("level",false);
+  fCompressionCmd->SetRange("level>=0 && level<=9");
+  fCompressionCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fChunkSizeCmd = new G4UIcmdWithAnInteger("/B3/listMode/chunkSize",this);
+  fChunkSizeCmd->SetGuidance("Number of records per chunk.");
+  fChunkSizeCmd->SetParameterName("nbRecords",false);
+  fChunkSizeCmd->SetRange("nbRecords>0");
+  fChunkSizeCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ListModeMessenger::~B3ListModeMessenger()
+{
+  delete fEnableCmd;
+  delete fCompressionCmd;
+  delete fChunkSizeCmd;
+  delete fDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ListModeMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if ( command == fEnableCmd ) {
+    fListMode->SetEnabled(fEnableCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fCompressionCmd ) {
+    fListMode->SetCompression(fCompressionCmd->GetNewIntValue(newValue));
+  }
+  else if ( command == fChunkSizeCmd ) {
+    fListMode->SetChunkSize(fChunkSizeCmd->GetNewIntValue(newValue));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
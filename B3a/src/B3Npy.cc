@@ -0,0 +1,108 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3Npy.cc
+/// \brief Implementation of the B3Npy class
+
+#include "B3Npy.hh"
+
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3Npy::WriteHeader(std::ostream& output, const G4String& descr,
+                        const std::vector<size_t>& shape)
+{
+  std::ostringstream dict;
+  dict << "{'descr': '" << descr << "', 'fortran_order': False, 'shape': (";
+  for (size_t i = 0; i < shape.size(); ++i) dict << shape[i] << ", ";
+  dict << "), }";
+
+  // magic (6) + version (2) + header length (2) + dictionary,
+  // padded with spaces and a newline to a multiple of 64 bytes
+  std::string header = dict.str();
+  size_t total = 10 + header.size() + 1;
+  header.append((64 - total % 64) % 64, ' ');
+  header.push_back('\n');
+
+  unsigned short length = header.size();
+  const char magic[8] = { '\x93', 'N', 'U', 'M', 'P', 'Y', 1, 0 };
+  output.write(magic, 8);
+  char lengthBytes[2] = { char(length & 0xff), char((length >> 8) & 0xff) };
+  output.write(lengthBytes, 2);
+  output.write(header.data(), header.size());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3Npy::ReadHeader(std::istream& input, G4String& descr,
+                         std::vector<size_t>& shape)
+{
+  char magic[8];
+  if (!input.read(magic, 8) || std::string(magic, 6) != "\x93NUMPY") {
+    return false;
+  }
+
+  // version 1 has a 2-byte header length, versions 2 and 3 a 4-byte one
+  unsigned char lengthBytes[4] = { 0, 0, 0, 0 };
+  size_t nbLengthBytes = (magic[6] == 1) ? 2 : 4;
+  if (!input.read(reinterpret_cast<char*>(lengthBytes), nbLengthBytes)) {
+    return false;
+  }
+  size_t length = 0;
+  for (size_t i = nbLengthBytes; i > 0; --i) {
+    length = (length << 8) | lengthBytes[i-1];
+  }
+  std::string header(length, ' ');
+  if (!input.read(&header[0], length)) return false;
+
+  // only C-ordered arrays, as written by Write()
+  if (header.find("'fortran_order': False") == std::string::npos) {
+    return false;
+  }
+
+  size_t begin = header.find("'descr': '");
+  if (begin == std::string::npos) return false;
+  begin += 10;
+  size_t end = header.find('\'', begin);
+  if (end == std::string::npos) return false;
+  descr = header.substr(begin, end - begin);
+
+  begin = header.find("'shape': (");
+  if (begin == std::string::npos) return false;
+  begin += 10;
+  end = header.find(')', begin);
+  if (end == std::string::npos) return false;
+  std::string dims = header.substr(begin, end - begin);
+  for (size_t i = 0; i < dims.size(); ++i) if (dims[i] == ',') dims[i] = ' ';
+  std::istringstream is(dims);
+  shape.clear();
+  size_t dim;
+  while (is >> dim) shape.push_back(dim);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,200 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3NpyMerge.cc
+/// \brief Implementation of the B3NpyMerge class
+
+#include "B3NpyMerge.hh"
+#include "B3Npy.hh"
+
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+
+namespace
+{
+  void Warn(const G4String& method, const G4String& message)
+  {
+    G4Exception(("B3NpyMerge::" + method + "()").c_str(), "MyCode0004",
+                JustWarning, message.c_str());
+  }
+
+  // opens an input and checks its type and shape against the first one
+  G4bool Open(std::ifstream& input, const G4String& fileName,
+              G4String& descr, std::vector<size_t>& shape, size_t& size)
+  {
+    input.open(fileName, std::ios::binary);
+    G4String fileDescr;
+    std::vector<size_t> fileShape;
+    if (!input || !B3Npy::ReadHeader(input, fileDescr, fileShape)) {
+      Warn("Open", "cannot read " + fileName);
+      return false;
+    }
+    if (descr.empty()) {
+      descr = fileDescr;
+      shape = fileShape;
+      size = 1;
+      for (size_t k = 0; k < shape.size(); ++k) size *= shape[k];
+    }
+    else if (fileDescr != descr || fileShape != shape) {
+      Warn("Open", fileName + " differs in type or shape from the first input");
+      return false;
+    }
+    return true;
+  }
+
+  template <typename T, typename S>
+  G4bool Read(std::istream& input, std::vector<S>& data)
+  {
+    std::vector<T> values(data.size());
+    if (!input.read(reinterpret_cast<char*>(&values[0]),
+                    values.size()*sizeof(T))) return false;
+    for (size_t i = 0; i < data.size(); ++i) data[i] = values[i];
+    return true;
+  }
+
+  // checked against the range of T
+  template <typename T, typename S>
+  G4bool Write(const G4String& fileName, const std::vector<size_t>& shape,
+               const std::vector<S>& sum)
+  {
+    std::vector<T> data(sum.size());
+    for (size_t i = 0; i < sum.size(); ++i) {
+      if (sum[i] > S(std::numeric_limits<T>::max()) ||
+          sum[i] < S(std::numeric_limits<T>::lowest())) {
+        Warn("Sum", fileName + ": an element overflows " + B3Npy::Descr<T>());
+        return false;
+      }
+      data[i] = T(sum[i]);
+    }
+    return B3Npy::Write(fileName, shape, &data[0]);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3NpyMerge::Sum(const G4String& output,
+                       const std::vector<G4String>& inputs)
+{
+  G4String descr;
+  std::vector<size_t> shape;
+  size_t size = 0;
+  std::vector<G4long>   intSum, intData;
+  std::vector<G4double> doubleSum, doubleData;
+
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    std::ifstream input;
+    if (!Open(input, inputs[i], descr, shape, size)) return false;
+    if (i == 0 && descr == "<f8") {
+      doubleSum.assign(size, 0.);
+      doubleData.resize(size);
+    }
+    else if (i == 0) {
+      intSum.assign(size, 0);
+      intData.resize(size);
+    }
+
+    G4bool ok = false;
+    if (descr == "<u4")      ok = Read<uint32_t>(input, intData);
+    else if (descr == "<i4") ok = Read<int32_t>(input, intData);
+    else if (descr == "<f8") ok = Read<G4double>(input, doubleData);
+    else {
+      Warn("Sum", inputs[i] + ": unsupported type " + descr);
+      return false;
+    }
+    if (!ok) {
+      Warn("Sum", inputs[i] + " is truncated");
+      return false;
+    }
+    for (size_t k = 0; k < intSum.size(); ++k)    intSum[k] += intData[k];
+    for (size_t k = 0; k < doubleSum.size(); ++k) doubleSum[k] += doubleData[k];
+  }
+
+  if (descr == "<u4") return Write<unsigned int>(output, shape, intSum);
+  if (descr == "<i4") return Write<G4int>(output, shape, intSum);
+  return B3Npy::Write(output, shape, &doubleSum[0]);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3NpyMerge::Average(const G4String& output,
+                           const std::vector<G4String>& inputs,
+                           const std::vector<G4double>& nofEvents)
+{
+  G4double total = 0.;
+  for (size_t i = 0; i < nofEvents.size(); ++i) total += nofEvents[i];
+  if (inputs.size() != nofEvents.size() || total <= 0.) {
+    Warn("Average", output + ": one number of events per input is needed");
+    return false;
+  }
+
+  G4String descr;
+  std::vector<size_t> shape;
+  size_t size = 0;
+  std::vector<G4double> mean, variance, data;
+
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    std::ifstream input;
+    if (!Open(input, inputs[i], descr, shape, size)) return false;
+    if (descr != "<f8" || shape.empty() || shape[0] % 2) {
+      Warn("Average", inputs[i] + " is not an array of mean and error planes");
+      return false;
+    }
+    if (i == 0) {
+      mean.assign(size/2, 0.);
+      variance.assign(size/2, 0.);
+      data.resize(size);
+    }
+    if (!Read<G4double>(input, data)) {
+      Warn("Average", inputs[i] + " is truncated");
+      return false;
+    }
+
+    // plane 2p holds the means, plane 2p+1 their errors
+    G4double weight = nofEvents[i]/total;
+    size_t planeSize = size/shape[0];
+    for (size_t p = 0; p < shape[0]/2; ++p) {
+      const G4double* m = &data[2*p*planeSize];
+      const G4double* e = m + planeSize;
+      for (size_t k = 0; k < planeSize; ++k) {
+        mean[p*planeSize + k]     += weight*m[k];
+        variance[p*planeSize + k] += weight*weight*e[k]*e[k];
+      }
+    }
+  }
+
+  size_t planeSize = size/shape[0];
+  for (size_t p = 0; p < shape[0]/2; ++p) {
+    for (size_t k = 0; k < planeSize; ++k) {
+      data[2*p*planeSize + k] = mean[p*planeSize + k];
+      data[(2*p + 1)*planeSize + k] = std::sqrt(variance[p*planeSize + k]);
+    }
+  }
+  return B3Npy::Write(output, shape, &data[0]);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
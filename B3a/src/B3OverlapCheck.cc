@@ -0,0 +1,209 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3OverlapCheck.cc
+/// \brief Implementation of the B3OverlapCheck class
+
+#include "B3OverlapCheck.hh"
+
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPVParameterisation.hh"
+#include "G4VSolid.hh"
+#include "G4Timer.hh"
+#include "G4ios.hh"
+
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+
+namespace {
+
+// FNV-1a over the description of the geometry
+std::uint64_t HashText(std::uint64_t hash, const std::string& text)
+{
+  for (size_t i = 0; i < text.size(); ++i) {
+    hash ^= static_cast<unsigned char>(text[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+void Describe(std::ostream& os, G4VPhysicalVolume* volume)
+{
+  os << volume->GetName() << ' ' << volume->GetCopyNo() << ' '
+     << volume->GetMultiplicity() << ' ' << volume->GetTranslation() << ' ';
+  const G4RotationMatrix* rotation = volume->GetRotation();
+  if (rotation) os << *rotation;
+  if (volume->IsReplicated()) {
+    EAxis axis;
+    G4int nbReplicas;
+    G4double width, offset;
+    G4bool consuming;
+    volume->GetReplicationData(axis, nbReplicas, width, offset, consuming);
+    os << axis << ' ' << width << ' ' << offset << ' ';
+  }
+  volume->GetLogicalVolume()->GetSolid()->StreamInfo(os);
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3OverlapCheck::B3OverlapCheck()
+ : fEnabled(true),
+   fForced(false),
+   fResolution(1000),
+   fCacheFile("B3overlaps.cache")
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3OverlapCheck::~B3OverlapCheck()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3OverlapCheck::CollectVolumes(G4VPhysicalVolume* world,
+                                    Volumes& volumes, Volumes& checked)
+{
+  // each logical volume once, whatever the number of its placements
+  std::set<G4LogicalVolume*> done;
+  std::vector<G4LogicalVolume*> mothers(1, world->GetLogicalVolume());
+  while (!mothers.empty()) {
+    G4LogicalVolume* mother = mothers.back();
+    mothers.pop_back();
+    if (!done.insert(mother).second) continue;
+
+    for (G4int i = 0; i < G4int(mother->GetNoDaughters()); ++i) {
+      G4VPhysicalVolume* daughter = mother->GetDaughter(i);
+      mothers.push_back(daughter->GetLogicalVolume());
+      volumes.push_back(daughter);
+      // nothing to check in a replica, nor in regular voxels
+      if (daughter->IsReplicated() && !daughter->IsParameterised()) continue;
+      if (daughter->IsRegularStructure()) continue;
+      checked.push_back(daughter);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::uint64_t B3OverlapCheck::Hash(const Volumes& volumes)
+{
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < volumes.size(); ++i) {
+    G4VPhysicalVolume* volume = volumes[i];
+    std::ostringstream os;
+    os << std::setprecision(12)
+       << volume->GetMotherLogical()->GetName() << ' ';
+    Describe(os, volume);
+    // every copy of a parameterisation, moved as in CheckOverlaps();
+    // the regular voxels are given by their container and their size
+    G4VPVParameterisation* parameterisation = volume->GetParameterisation();
+    if (parameterisation && !volume->IsRegularStructure()) {
+      for (G4int copy = 0; copy < volume->GetMultiplicity(); ++copy) {
+        parameterisation->ComputeTransformation(copy, volume);
+        os << volume->GetTranslation() << ' ';
+        if (volume->GetRotation()) os << *volume->GetRotation();
+      }
+    }
+    hash = HashText(hash, os.str());
+  }
+  return hash;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3OverlapCheck::IsCached(std::uint64_t hash) const
+{
+  std::ifstream input(fCacheFile);
+  std::uint64_t cached = 0;
+  while (input >> std::hex >> cached) {
+    if (cached == hash) return true;
+  }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3OverlapCheck::AddToCache(std::uint64_t hash) const
+{
+  std::ofstream output(fCacheFile, std::ios::app);
+  output << std::hex << std::setw(16) << std::setfill('0') << hash << '\n';
+  if (!output) {
+    G4ExceptionDescription msg;
+    msg << "Cannot write the overlap cache " << fCacheFile << ".";
+    G4Exception("B3OverlapCheck::AddToCache()", "MyCode0013",
+                JustWarning, msg);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3OverlapCheck::Check(G4VPhysicalVolume* world) const
+{
+  if (!fEnabled) return;
+
+  Volumes volumes, checked;
+  CollectVolumes(world, volumes, checked);
+  std::uint64_t hash = Hash(volumes);
+  std::ostringstream hashText;
+  hashText << std::hex << std::setw(16) << std::setfill('0') << hash;
+
+  G4bool cached = !fCacheFile.empty() && IsCached(hash);
+  if (cached && !fForced) {
+    G4cout << "\nOverlaps: geometry " << hashText.str()
+           << " already checked in " << fCacheFile << G4endl;
+    return;
+  }
+
+  G4Timer timer;
+  timer.Start();
+  size_t nbVolumes = 0;
+  G4int nbOverlaps = 0;
+  for (size_t i = 0; i < checked.size(); ++i) {
+    nbVolumes += checked[i]->GetMultiplicity();
+    if (checked[i]->CheckOverlaps(fResolution, 0., false, 1)) ++nbOverlaps;
+  }
+  timer.Stop();
+
+  G4cout << "\nOverlaps: " << nbVolumes << " volumes checked in "
+         << timer.GetRealElapsed() << " s" << G4endl;
+
+  if (nbOverlaps > 0) {
+    G4ExceptionDescription msg;
+    msg << nbOverlaps << " volumes overlap; geometry " << hashText.str()
+        << " is not cached.";
+    G4Exception("B3OverlapCheck::Check()", "MyCode0013", JustWarning, msg);
+  }
+  else if (!fCacheFile.empty() && !cached) {
+    AddToCache(hash);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
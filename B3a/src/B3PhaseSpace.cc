@@ -0,0 +1,359 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3PhaseSpace.cc
+/// \brief Implementation of the B3PhaseSpace class
+
+#include "B3PhaseSpace.hh"
+#include "B3PhaseSpaceMessenger.hh"
+
+#include "G4Event.hh"
+#include "G4EventManager.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4ParticleTable.hh"
+#include "G4IonTable.hh"
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4LogicalVolume.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4Threading.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <sstream>
+
+#include <dirent.h>
+
+namespace
+{
+  const size_t kChunkSize = 4096;
+  const uint32_t kVersion = 1;
+
+  // header: "B3PS", version, record size, number of histories
+  const std::streamoff kHistoriesOffset = 12;
+  const std::streamoff kHeaderSize = 20;
+
+  // the logical volume and all the volumes it contains
+  void Mark(const G4LogicalVolume* volume, std::vector<char>& marks)
+  {
+    size_t id = volume->GetInstanceID();
+    if (id >= marks.size()) marks.resize(id + 1, 0);
+    if (marks[id]) return;
+    marks[id] = 1;
+    for (G4int i = 0; i < volume->GetNoDaughters(); ++i) {
+      Mark(volume->GetDaughter(i)->GetLogicalVolume(), marks);
+    }
+  }
+}
+
+std::vector<G4String> B3PhaseSpace::fgFiles;
+std::vector<B3PhaseSpace::History> B3PhaseSpace::fgHistories;
+std::uint64_t B3PhaseSpace::fgNofHistories = 0;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3PhaseSpace::B3PhaseSpace()
+ : fRecording(false),
+   fKill(true),
+   fMessenger(0)
+{
+  static_assert(sizeof(B3PhaseSpaceRecord) == 44,
+                "phase-space records must be 44 bytes");
+  fMessenger = new B3PhaseSpaceMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3PhaseSpace::~B3PhaseSpace()
+{
+  EndOfRun(0);
+  for (size_t i = 0; i < fInputs.size(); ++i) delete fInputs[i];
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3PhaseSpace::BeginOfRun(const G4String& runName, G4int nofEvents,
+                              G4bool master, G4bool tracking)
+{
+  // the files of the previous replay may have been rewritten
+  for (size_t i = 0; i < fInputs.size(); ++i) delete fInputs[i];
+  fInputs.clear();
+
+  if (master) {
+    fgFiles.clear();
+    fgHistories.clear();
+    fgNofHistories = 0;
+    if (IsReplaying()) {
+      fgFiles = FindFiles();
+      std::sort(fgFiles.begin(), fgFiles.end());
+      for (size_t i = 0; i < fgFiles.size(); ++i) {
+        if (!Index(fgFiles[i], i)) {
+          G4ExceptionDescription msg;
+          msg << "Cannot read the phase-space file " << fgFiles[i] << ".";
+          G4Exception("B3PhaseSpace::BeginOfRun()", "MyCode0011",
+                      FatalException, msg);
+        }
+      }
+      std::sort(fgHistories.begin(), fgHistories.end());
+      if (fgNofHistories == 0) {
+        G4ExceptionDescription msg;
+        msg << "No phase space recorded in " << fReplayName
+            << "_ps*.bin: the events are empty.";
+        G4Exception("B3PhaseSpace::BeginOfRun()", "MyCode0011",
+                    JustWarning, msg);
+      }
+      G4cout << " Phase space: " << fgHistories.size() << " of "
+             << fgNofHistories << " histories with particles, from "
+             << fgFiles.size() << " files of " << fReplayName << G4endl;
+      if (std::uint64_t(nofEvents) > fgNofHistories && fgNofHistories > 0) {
+        G4ExceptionDescription msg;
+        msg << nofEvents << " events replay " << fgNofHistories
+            << " histories: the histories are reused.";
+        G4Exception("B3PhaseSpace::BeginOfRun()", "MyCode0011",
+                    JustWarning, msg);
+      }
+    }
+  }
+
+  if (!tracking || !fRecording) return;
+
+  fInPatient.clear();
+  G4LogicalVolume* patient
+    = G4LogicalVolumeStore::GetInstance()->GetVolume("PatientLV", false);
+  if (!patient) {
+    G4Exception("B3PhaseSpace::BeginOfRun()", "MyCode0011", JustWarning,
+                "PatientLV not found: no phase space recorded.");
+    return;
+  }
+  Mark(patient, fInPatient);
+
+  std::ostringstream fileName;
+  fileName << runName << "_ps";
+  if (G4Threading::IsWorkerThread()) {
+    fileName << "_t" << G4Threading::G4GetThreadId();
+  }
+  fileName << ".bin";
+  fOutput.open(fileName.str(), std::ios::binary);
+  if (!fOutput) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open " << fileName.str() << " for writing.";
+    G4Exception("B3PhaseSpace::BeginOfRun()", "MyCode0011", JustWarning, msg);
+    return;
+  }
+  const uint32_t header[2]
+    = { kVersion, uint32_t(sizeof(B3PhaseSpaceRecord)) };
+  const std::uint64_t nofHistories = 0;
+  fOutput.write("B3PS", 4);
+  fOutput.write(reinterpret_cast<const char*>(header), sizeof(header));
+  fOutput.write(reinterpret_cast<const char*>(&nofHistories),
+                sizeof(nofHistories));
+  fRecords.reserve(kChunkSize);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3PhaseSpace::Record(const G4Step* step)
+{
+  const G4StepPoint* postPoint = step->GetPostStepPoint();
+  if (postPoint->GetStepStatus() != fGeomBoundary) return;
+
+  // from the patient to a volume outside it, or out of the world
+  size_t pre = step->GetPreStepPoint()->GetPhysicalVolume()
+                 ->GetLogicalVolume()->GetInstanceID();
+  if (pre >= fInPatient.size() || !fInPatient[pre]) return;
+  const G4VPhysicalVolume* postVolume = postPoint->GetPhysicalVolume();
+  if (postVolume) {
+    size_t post = postVolume->GetLogicalVolume()->GetInstanceID();
+    if (post < fInPatient.size() && fInPatient[post]) return;
+  }
+
+  G4Track* track = step->GetTrack();
+  const G4ThreeVector& position = postPoint->GetPosition();
+  const G4ThreeVector& direction = postPoint->GetMomentumDirection();
+  B3PhaseSpaceRecord record = {
+    G4EventManager::GetEventManager()->GetConstCurrentEvent()->GetEventID(),
+    track->GetDefinition()->GetPDGEncoding(),
+    G4float(postPoint->GetKineticEnergy()/keV),
+    G4float(postPoint->GetGlobalTime()/ns),
+    { G4float(position.x()/mm), G4float(position.y()/mm),
+      G4float(position.z()/mm) },
+    { G4float(direction.x()), G4float(direction.y()),
+      G4float(direction.z()) },
+    G4float(track->GetWeight()) };
+  fRecords.push_back(record);
+  if (fRecords.size() >= kChunkSize) Flush();
+
+  if (fKill) track->SetTrackStatus(fStopAndKill);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3PhaseSpace::Flush()
+{
+  if (fRecords.empty()) return;
+  fOutput.write(reinterpret_cast<const char*>(&fRecords[0]),
+                fRecords.size()*sizeof(B3PhaseSpaceRecord));
+  fRecords.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3PhaseSpace::EndOfRun(G4int nofEvents)
+{
+  if (!fOutput.is_open()) return;
+
+  // the histories simulated by the thread, for the normalisation
+  Flush();
+  std::uint64_t nofHistories = nofEvents;
+  fOutput.seekp(kHistoriesOffset);
+  fOutput.write(reinterpret_cast<const char*>(&nofHistories),
+                sizeof(nofHistories));
+  fOutput.close();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<G4String> B3PhaseSpace::FindFiles() const
+{
+  // <directory>/<base>_ps[_t<thread>].bin
+  G4String directory = ".";
+  G4String base = fReplayName;
+  size_t slash = fReplayName.rfind('/');
+  if (slash != std::string::npos) {
+    directory = fReplayName.substr(0, slash + 1);
+    base = fReplayName.substr(slash + 1);
+  }
+  G4String prefix = base + "_ps";
+
+  std::vector<G4String> files;
+  DIR* dir = opendir(directory.c_str());
+  if (!dir) return files;
+  while (dirent* entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.compare(0, prefix.size(), prefix) != 0) continue;
+    std::string rest = name.substr(prefix.size());
+    if (rest != ".bin" &&
+        (rest.compare(0, 2, "_t") != 0 || rest.size() < 7 ||
+         rest.compare(rest.size() - 4, 4, ".bin") != 0)) continue;
+    files.push_back((slash != std::string::npos) ? directory + name : name);
+  }
+  closedir(dir);
+  return files;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3PhaseSpace::Index(const G4String& fileName, G4int file)
+{
+  std::ifstream input(fileName, std::ios::binary);
+  char magic[4];
+  uint32_t header[2];
+  std::uint64_t nofHistories;
+  if (!input.read(magic, 4) || G4String(magic, 4) != "B3PS" ||
+      !input.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+      header[0] != kVersion || header[1] != sizeof(B3PhaseSpaceRecord) ||
+      !input.read(reinterpret_cast<char*>(&nofHistories),
+                  sizeof(nofHistories))) return false;
+  fgNofHistories += nofHistories;
+
+  // the records of an event are consecutive
+  std::vector<B3PhaseSpaceRecord> records(kChunkSize);
+  std::uint64_t offset = kHeaderSize;
+  for (;;) {
+    input.read(reinterpret_cast<char*>(&records[0]),
+               records.size()*sizeof(B3PhaseSpaceRecord));
+    size_t nofRecords = input.gcount()/sizeof(B3PhaseSpaceRecord);
+    for (size_t i = 0; i < nofRecords; ++i) {
+      if (fgHistories.empty() || fgHistories.back().file != file ||
+          fgHistories.back().eventID != records[i].eventID) {
+        History history = { records[i].eventID, file, 0, offset };
+        fgHistories.push_back(history);
+      }
+      ++fgHistories.back().nofRecords;
+      offset += sizeof(B3PhaseSpaceRecord);
+    }
+    if (nofRecords < records.size()) break;
+  }
+  return input.eof();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3PhaseSpace::GeneratePrimaries(G4Event* event)
+{
+  if (fgNofHistories == 0) return;
+
+  // the history of the recording with the same event ID
+  History key = { G4int(event->GetEventID() % fgNofHistories), 0, 0, 0 };
+  std::vector<History>::const_iterator history
+    = std::lower_bound(fgHistories.begin(), fgHistories.end(), key);
+  if (history == fgHistories.end() || history->eventID != key.eventID) {
+    return;
+  }
+
+  if (fInputs.empty()) fInputs.resize(fgFiles.size(), 0);
+  std::ifstream*& input = fInputs[history->file];
+  if (!input) {
+    input = new std::ifstream(fgFiles[history->file], std::ios::binary);
+  }
+  std::vector<B3PhaseSpaceRecord> records(history->nofRecords);
+  input->seekg(history->offset);
+  if (!input->read(reinterpret_cast<char*>(&records[0]),
+                   records.size()*sizeof(B3PhaseSpaceRecord))) {
+    G4ExceptionDescription msg;
+    msg << "Cannot read the event " << key.eventID << " from "
+        << fgFiles[history->file] << ".";
+    G4Exception("B3PhaseSpace::GeneratePrimaries()", "MyCode0011",
+                FatalException, msg);
+  }
+
+  G4ParticleTable* particleTable = G4ParticleTable::GetParticleTable();
+  for (size_t i = 0; i < records.size(); ++i) {
+    const B3PhaseSpaceRecord& record = records[i];
+    G4ParticleDefinition* particle = particleTable->FindParticle(record.pdg);
+    if (!particle && record.pdg > 1000000000) {
+      particle = G4IonTable::GetIonTable()->GetIon(record.pdg);
+    }
+    if (!particle) continue;
+
+    G4PrimaryVertex* vertex = new G4PrimaryVertex(
+      G4ThreeVector(record.position[0], record.position[1],
+                    record.position[2])*mm, record.time*ns);
+    G4PrimaryParticle* primary = new G4PrimaryParticle(particle);
+    primary->SetKineticEnergy(record.energy*keV);
+    primary->SetMomentumDirection(
+      G4ThreeVector(record.direction[0], record.direction[1],
+                    record.direction[2]));
+    primary->SetWeight(record.weight);
+    vertex->SetPrimary(primary);
+    event->AddPrimaryVertex(vertex);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,98 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3PhaseSpaceMessenger.cc
+/// \brief Implementation of the B3PhaseSpaceMessenger class
+
+#include "B3PhaseSpaceMessenger.hh"
+#include "B3PhaseSpace.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAString.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3PhaseSpaceMessenger::B3PhaseSpaceMessenger(B3PhaseSpace* phaseSpace)
+ : G4UImessenger(),
+   fPhaseSpace(phaseSpace),
+   fDirectory(0),
+   fRecordCmd(0),
+   fKillCmd(0),
+   fReplayCmd(0)
+{
+  fDirectory = new G4UIdirectory("/B3/phaseSpace/");
+  fDirectory->SetGuidance("Phase space of the particles leaving the patient.");
+
+  fRecordCmd = new G4UIcmdWithABool("/B3/phaseSpace/record",this);
+  fRecordCmd->SetGuidance("Write the particles leaving PatientLV to");
+  fRecordCmd->SetGuidance("<output>_ps_t<thread>.bin.");
+  fRecordCmd->SetParameterName("flag",true);
+  fRecordCmd->SetDefaultValue(true);
+  fRecordCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fKillCmd = new G4UIcmdWithABool("/B3/phaseSpace/kill",this);
+  fKillCmd->SetGuidance("Stop the recorded particles at the patient surface");
+  fKillCmd->SetGuidance("(default), or track them on in the detector.");
+  fKillCmd->SetParameterName("flag",true);
+  fKillCmd->SetDefaultValue(true);
+  fKillCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fReplayCmd = new G4UIcmdWithAString("/B3/phaseSpace/replay",this);
+  fReplayCmd->SetGuidance("Generate the events from the phase space recorded");
+  fReplayCmd->SetGuidance("by the run with this output name (with its _runN");
+  fReplayCmd->SetGuidance("suffix for a later run); none for the gun.");
+  fReplayCmd->SetParameterName("output",false);
+  fReplayCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3PhaseSpaceMessenger::~B3PhaseSpaceMessenger()
+{
+  delete fRecordCmd;
+  delete fKillCmd;
+  delete fReplayCmd;
+  delete fDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3PhaseSpaceMessenger::SetNewValue(G4UIcommand* command,
+                                        G4String newValue)
+{
+  if ( command == fRecordCmd ) {
+    fPhaseSpace->SetRecording(fRecordCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fKillCmd ) {
+    fPhaseSpace->SetKill(fKillCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fReplayCmd ) {
+    fPhaseSpace->SetReplay(newValue == "none" ? G4String() : newValue);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
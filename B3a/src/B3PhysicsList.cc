@@ -28,31 +28,83 @@
 /// \brief Implementation of the B3PhysicsList class
 
 #include "B3PhysicsList.hh"
+#include "B3PhysicsListMessenger.hh"
 
-#include "G4DecayPhysics.hh"
-#include "G4EmStandardPhysics.hh"
+#include "G4EmLivermorePhysics.hh"
+#include "G4EmPenelopePhysics.hh"
+#include "G4EmStandardPhysics_option4.hh"
 #include "G4RadioactiveDecayPhysics.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-B3PhysicsList::B3PhysicsList() 
-: G4VModularPhysicsList(){
+B3PhysicsList::B3PhysicsList(const G4String& emName) 
+: G4VModularPhysicsList(),
+  fEmName(),
+  fRadioactiveDecay(0),
+  fMessenger(0)
+{
   SetVerboseLevel(1);
 
-  // Default physics
-  RegisterPhysics(new G4DecayPhysics());
-
   // EM physics
-  RegisterPhysics(new G4EmStandardPhysics());
+  SelectEmPhysics(emName);
 
-  // Radioactive decay
-  RegisterPhysics(new G4RadioactiveDecayPhysics());
+  fMessenger = new B3PhysicsListMessenger(this);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 B3PhysicsList::~B3PhysicsList()
 { 
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3PhysicsList::IsEmPhysicsName(const G4String& name)
+{
+  return ( name == "livermore" || name == "penelope" || name == "option4" );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3PhysicsList::SelectEmPhysics(const G4String& name)
+{
+  if ( name == fEmName ) return;
+
+  G4VPhysicsConstructor* emPhysics = 0;
+  if      ( name == "livermore" ) emPhysics = new G4EmLivermorePhysics();
+  else if ( name == "penelope" )  emPhysics = new G4EmPenelopePhysics();
+  else if ( name == "option4" )   emPhysics = new G4EmStandardPhysics_option4();
+  else {
+    G4ExceptionDescription msg;
+    msg << "Unknown EM physics \"" << name << "\".\n";
+    msg << "Available: livermore, penelope, option4.";
+    G4Exception("B3PhysicsList::SelectEmPhysics()",
+     "MyCode0003", JustWarning, msg);
+    return;
+  }
+
+  // the constructor of the same (electromagnetic) type is replaced,
+  // or registered if there is none yet
+  ReplacePhysics(emPhysics);
+  fEmName = name;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3PhysicsList::SetRadioactiveDecay(G4bool flag)
+{
+  if ( flag == GetRadioactiveDecay() ) return;
+
+  if ( flag ) {
+    fRadioactiveDecay = new G4RadioactiveDecayPhysics();
+    RegisterPhysics(fRadioactiveDecay);
+  }
+  else {
+    RemovePhysics(fRadioactiveDecay);
+    delete fRadioactiveDecay;
+    fRadioactiveDecay = 0;
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
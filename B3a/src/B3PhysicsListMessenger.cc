@@ -0,0 +1,85 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3PhysicsListMessenger.cc
+/// \brief Implementation of the B3PhysicsListMessenger class
+
+#include "B3PhysicsListMessenger.hh"
+#include "B3PhysicsList.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3PhysicsListMessenger::B3PhysicsListMessenger(B3PhysicsList* physicsList)
+ : G4UImessenger(),
+   fPhysicsList(physicsList),
+   fPhysDir(0),
+   fEmCmd(0),
+   fRadioactiveDecayCmd(0)
+{
+  fPhysDir = new G4UIdirectory("/B3/phys/", false);
+  fPhysDir->SetGuidance("Physics list control.");
+
+  fEmCmd = new G4UIcmdWithAString("/B3/phys/em",this);
+  fEmCmd->SetGuidance("Select the electromagnetic physics constructor.");
+  fEmCmd->SetParameterName("name",false);
+  fEmCmd->SetCandidates("livermore penelope option4");
+  fEmCmd->AvailableForStates(G4State_PreInit);
+  fEmCmd->SetToBeBroadcasted(false);
+
+  fRadioactiveDecayCmd = new G4UIcmdWithABool("/B3/phys/radioactiveDecay",this);
+  fRadioactiveDecayCmd->SetGuidance("Add or remove G4RadioactiveDecayPhysics.");
+  fRadioactiveDecayCmd->SetParameterName("flag",true);
+  fRadioactiveDecayCmd->SetDefaultValue(true);
+  fRadioactiveDecayCmd->AvailableForStates(G4State_PreInit);
+  fRadioactiveDecayCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3PhysicsListMessenger::~B3PhysicsListMessenger()
+{
+  delete fEmCmd;
+  delete fRadioactiveDecayCmd;
+  delete fPhysDir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3PhysicsListMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if ( command == fEmCmd ) {
+    fPhysicsList->SelectEmPhysics(newValue);
+  }
+  else if ( command == fRadioactiveDecayCmd ) {
+    fPhysicsList->SetRadioactiveDecay(fRadioactiveDecayCmd->GetNewBoolValue(newValue));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
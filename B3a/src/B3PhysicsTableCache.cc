@@ -0,0 +1,335 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3PhysicsTableCache.cc
+/// \brief Implementation of the B3PhysicsTableCache class
+
+#include "B3PhysicsTableCache.hh"
+#include "B3PhysicsTableCacheMessenger.hh"
+
+#include "G4VUserPhysicsList.hh"
+#include "G4StateManager.hh"
+#include "G4ParticleTable.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4ProcessManager.hh"
+#include "G4ProcessVector.hh"
+#include "G4VEmProcess.hh"
+#include "G4VEnergyLossProcess.hh"
+#include "G4VMultipleScattering.hh"
+#include "G4VEmModel.hh"
+#include "G4EmParameters.hh"
+#include "G4RegionStore.hh"
+#include "G4Region.hh"
+#include "G4ProductionCuts.hh"
+#include "G4ProductionCutsTable.hh"
+#include "G4Material.hh"
+#include "G4Version.hh"
+#include "G4ios.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+  // written last in a set of tables, which is complete when it is there
+  const char* const kInfoFile = "B3tables.info";
+
+  std::uint64_t HashText(std::uint64_t hash, const std::string& text)
+  {
+    for (size_t i = 0; i < text.size(); ++i) {
+      hash ^= static_cast<unsigned char>(text[i]);
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+
+  // the models given to an EM process; the process names alone do not
+  // tell Livermore from Penelope or the standard models
+  template <class Process>
+  void StreamModels(std::ostream& os, const Process* process)
+  {
+    for (size_t i = 0; process->EmModel(i); ++i) {
+      os << ' ' << process->EmModel(i)->GetName();
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3PhysicsTableCache::B3PhysicsTableCache(G4VUserPhysicsList* physicsList)
+ : G4VStateDependent(),
+   fPhysicsList(physicsList),
+   fDirectory("B3tables"),
+   fKey(0),
+   fHasKey(false),
+   fPending(false),
+   fPendingKey(0),
+   fTableDirectory(),
+   fRetrieved(false),
+   fTimer(),
+   fMemory(0.),
+   fMessenger(0)
+{
+  fMessenger = new B3PhysicsTableCacheMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3PhysicsTableCache::~B3PhysicsTableCache()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3PhysicsTableCache::Notify(G4ApplicationState requestedState)
+{
+  // called before the change: the current state is the previous one.
+  // /run/initialize and a geometry rebuild also go from Idle to Init,
+  // but only the run initialization goes on to GeomClosed
+  G4ApplicationState state
+    = G4StateManager::GetStateManager()->GetCurrentState();
+  if (state == G4State_Idle && requestedState == G4State_Init) {
+    BeginTables();
+  }
+  else if (state == G4State_Idle && requestedState == G4State_GeomClosed) {
+    EndTables();
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3PhysicsTableCache::BeginTables()
+{
+  fPending = false;
+  if (fDirectory.empty()) return;
+
+  // the tables in memory are kept by the kernel
+  std::uint64_t key = Hash();
+  if (fHasKey && key == fKey) return;
+
+  std::ostringstream name;
+  name << fDirectory << '/'
+       << std::hex << std::setw(16) << std::setfill('0') << key;
+  fTableDirectory = name.str();
+
+  std::ifstream info(fTableDirectory + '/' + kInfoFile);
+  fRetrieved = info.good();
+  if (fRetrieved) {
+    fPhysicsList->SetPhysicsTableRetrieved(fTableDirectory);
+  }
+  else {
+    fPhysicsList->ResetPhysicsTableRetrieved();
+  }
+
+  fPending = true;
+  fPendingKey = key;
+  fMemory = ResidentMemory();
+  fTimer.Start();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3PhysicsTableCache::EndTables()
+{
+  if (!fPending) return;
+  fPending = false;
+  fTimer.Stop();
+  G4double time = fTimer.GetRealElapsed();
+  G4double memory = ResidentMemory() - fMemory;
+  fKey = fPendingKey;
+  fHasKey = true;
+
+  // the workers build their tables from those of the master
+  fPhysicsList->ResetPhysicsTableRetrieved();
+
+  std::streamsize precision = G4cout.precision(3);
+  G4cout << "\nPhysics tables " << fTableDirectory << ": ";
+  if (fRetrieved) {
+    G4double buildTime = 0., buildMemory = 0.;
+    std::ifstream info(fTableDirectory + '/' + kInfoFile);
+    std::string word;
+    info >> word >> buildTime >> word >> buildMemory;
+    G4cout << "retrieved in " << time << " s, " << memory << " MB; built in "
+           << buildTime << " s, " << buildMemory << " MB when stored: "
+           << buildTime - time << " s and " << buildMemory - memory
+           << " MB saved" << G4endl;
+  }
+  else {
+    G4cout << "built in " << time << " s, " << memory << " MB";
+    if (Store(time, memory)) G4cout << ", stored";
+    G4cout << G4endl;
+  }
+  G4cout.precision(precision);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3PhysicsTableCache::Store(G4double buildTime,
+                                  G4double buildMemory) const
+{
+  mkdir(fDirectory.c_str(), 0755);
+  std::ostringstream tmpName;
+  tmpName << fTableDirectory << ".tmp" << getpid();
+  G4String tmpDirectory = tmpName.str();
+
+  G4bool stored = mkdir(tmpDirectory.c_str(), 0755) == 0
+               && fPhysicsList->StorePhysicsTable(tmpDirectory);
+  if (stored) {
+    std::ofstream info(tmpDirectory + '/' + kInfoFile);
+    info << "buildTime " << buildTime << "\nbuildMemory " << buildMemory
+         << std::endl;
+    stored = info.good();
+  }
+  // the rename fails if a concurrent job has stored the same key first
+  if (stored && std::rename(tmpDirectory.c_str(),
+                            fTableDirectory.c_str()) == 0) {
+    return true;
+  }
+  RemoveDirectory(tmpDirectory);
+
+  if (!stored) {
+    G4ExceptionDescription msg;
+    msg << "Cannot store the physics tables in " << fTableDirectory
+        << "; they will be built again by the next job.";
+    G4Exception("B3PhysicsTableCache::Store()", "MyCode0016",
+                JustWarning, msg);
+  }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::uint64_t B3PhysicsTableCache::Hash() const
+{
+  std::ostringstream os;
+  os << std::setprecision(17);
+
+  // version and data sets
+  os << G4VERSION_NUMBER << '\n';
+  const char* dataSets[] = { "G4LEDATA", "G4LEVELGAMMADATA", "G4PIIDATA",
+                             "G4ENSDFSTATEDATA", "G4RADIOACTIVEDATA",
+                             "G4PARTICLEXSDATA", "G4NEUTRONHPDATA" };
+  for (size_t i = 0; i < sizeof(dataSets)/sizeof(dataSets[0]); ++i) {
+    const char* path = std::getenv(dataSets[i]);
+    os << dataSets[i] << ' ' << (path ? path : "") << '\n';
+  }
+
+  // physics list
+  G4ParticleTable::G4PTblDicIterator* particles
+    = G4ParticleTable::GetParticleTable()->GetIterator();
+  particles->reset();
+  while ((*particles)()) {
+    G4ParticleDefinition* particle = particles->value();
+    G4ProcessManager* manager = particle->GetProcessManager();
+    if (!manager) continue;
+    os << particle->GetParticleName() << ':';
+    G4ProcessVector* processes = manager->GetProcessList();
+    for (G4int i = 0; i < G4int(processes->size()); ++i) {
+      const G4VProcess* process = (*processes)[i];
+      os << ' ' << process->GetProcessName();
+      if (const G4VEmProcess* em = dynamic_cast<const G4VEmProcess*>(process)) {
+        StreamModels(os, em);
+      }
+      else if (const G4VEnergyLossProcess* loss
+                 = dynamic_cast<const G4VEnergyLossProcess*>(process)) {
+        StreamModels(os, loss);
+      }
+      else if (const G4VMultipleScattering* msc
+                 = dynamic_cast<const G4VMultipleScattering*>(process)) {
+        StreamModels(os, msc);
+      }
+    }
+    os << '\n';
+  }
+  os << *G4EmParameters::Instance();
+
+  // cuts
+  G4ProductionCutsTable* cutsTable
+    = G4ProductionCutsTable::GetProductionCutsTable();
+  os << cutsTable->GetLowEdgeEnergy() << ' '
+     << cutsTable->GetHighEdgeEnergy() << '\n';
+  G4RegionStore* regions = G4RegionStore::GetInstance();
+  for (size_t i = 0; i < regions->size(); ++i) {
+    G4Region* region = (*regions)[i];
+    os << region->GetName();
+    G4ProductionCuts* cuts = region->GetProductionCuts();
+    for (G4int j = 0; cuts && j < 4; ++j) {
+      os << ' ' << cuts->GetProductionCut(j);
+    }
+    os << '\n';
+  }
+
+  // materials
+  const G4MaterialTable* materials = G4Material::GetMaterialTable();
+  for (size_t i = 0; i < materials->size(); ++i) {
+    const G4Material* material = (*materials)[i];
+    os << material->GetName() << ' ' << material->GetDensity() << ' '
+       << material->GetState() << ' ' << material->GetTemperature() << ' '
+       << material->GetIonisation()->GetMeanExcitationEnergy();
+    const G4double* fractions = material->GetFractionVector();
+    for (size_t j = 0; j < material->GetNumberOfElements(); ++j) {
+      os << ' ' << material->GetElement(j)->GetName() << ' ' << fractions[j];
+    }
+    os << '\n';
+  }
+
+  return HashText(14695981039346656037ULL, os.str());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double B3PhysicsTableCache::ResidentMemory()
+{
+  std::ifstream statm("/proc/self/statm");
+  G4double size = 0., resident = 0.;
+  if (!(statm >> size >> resident)) return 0.;
+  return resident*sysconf(_SC_PAGESIZE)/(1024.*1024.);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3PhysicsTableCache::RemoveDirectory(const G4String& name)
+{
+  DIR* dir = opendir(name.c_str());
+  if (!dir) return;
+  while (dirent* entry = readdir(dir)) {
+    std::string file = entry->d_name;
+    if (file != "." && file != "..") std::remove((name + '/' + file).c_str());
+  }
+  closedir(dir);
+  rmdir(name.c_str());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,74 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3PhysicsTableCacheMessenger.cc
+/// \brief Implementation of the B3PhysicsTableCacheMessenger class
+
+#include "B3PhysicsTableCacheMessenger.hh"
+#include "B3PhysicsTableCache.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3PhysicsTableCacheMessenger::B3PhysicsTableCacheMessenger(
+                                    B3PhysicsTableCache* cache)
+ : G4UImessenger(),
+   fCache(cache),
+   fDirectory(0),
+   fCacheDirectoryCmd(0)
+{
+  fDirectory = new G4UIdirectory("/B3/tables/");
+  fDirectory->SetGuidance("Cache of the physics tables.");
+
+  fCacheDirectoryCmd = new G4UIcmdWithAString("/B3/tables/cacheDirectory",this);
+  fCacheDirectoryCmd->SetGuidance("Directory of the stored physics tables,");
+  fCacheDirectoryCmd->SetGuidance("one set per key; none to always build them.");
+  fCacheDirectoryCmd->SetParameterName("directory",false);
+  fCacheDirectoryCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fCacheDirectoryCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3PhysicsTableCacheMessenger::~B3PhysicsTableCacheMessenger()
+{
+  delete fCacheDirectoryCmd;
+  delete fDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3PhysicsTableCacheMessenger::SetNewValue(G4UIcommand* command,
+                                               G4String newValue)
+{
+  if ( command == fCacheDirectoryCmd ) {
+    fCache->SetDirectory(newValue == "none" ? G4String() : newValue);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,118 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3PixelSD.cc
+/// \brief Implementation of the B3PixelSD class
+
+#include "B3PixelSD.hh"
+#include "B3TrackOrigin.hh"
+
+#include "G4Step.hh"
+#include "G4VTouchable.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3PixelSD::B3PixelSD(const G4String& name, G4int nbCrystals, G4int nbRings)
+ : G4VSensitiveDetector(name),
+   fNbCrystals(nbCrystals),
+   fNbRings(nbRings),
+   fEdep(nbCrystals*nbRings, 0.),
+   fTime(nbCrystals*nbRings, 0.),
+   fFlags(nbCrystals*nbRings, 0),
+   fDead(nbCrystals*nbRings, false),
+   fTouched()
+{
+  fTouched.reserve(nbCrystals*nbRings);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3PixelSD::~B3PixelSD()
+{ }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3PixelSD::SetSize(G4int nbCrystals, G4int nbRings)
+{
+  fNbCrystals = nbCrystals;
+  fNbRings = nbRings;
+  fEdep.assign(nbCrystals*nbRings, 0.);
+  fTime.assign(nbCrystals*nbRings, 0.);
+  fFlags.assign(nbCrystals*nbRings, 0);
+  fDead.assign(nbCrystals*nbRings, false);
+  fTouched.clear();
+  fTouched.reserve(nbCrystals*nbRings);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3PixelSD::Initialize(G4HCofThisEvent*)
+{
+  // clear only what the previous event has filled
+  for (size_t i = 0; i < fTouched.size(); ++i) {
+    fEdep[fTouched[i]] = 0.;
+    fFlags[fTouched[i]] = 0;
+  }
+  fTouched.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3PixelSD::ProcessHits(G4Step* step, G4TouchableHistory*)
+{
+  G4double edep = step->GetTotalEnergyDeposit();
+  if (edep <= 0.) return false;
+
+  const G4StepPoint* prePoint = step->GetPreStepPoint();
+  const G4VTouchable* touchable = prePoint->GetTouchable();
+  G4int crystal = touchable->GetCopyNumber(0);
+  G4int ring    = touchable->GetCopyNumber(1);
+  G4int pixel   = ring*fNbCrystals + crystal;
+  if (fDead[pixel]) return false;
+
+  AddDeposit(pixel, edep, prePoint->GetGlobalTime(),
+    B3TrackOrigin::Instance()->GetFlags(step->GetTrack()->GetTrackID()));
+
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3PixelSD::AddDeposit(G4int pixel, G4double edep, G4double time,
+                           G4int flags)
+{
+  if (fEdep[pixel] == 0.) {
+    fTouched.push_back(pixel);
+    fTime[pixel] = time;
+  }
+  else if (time < fTime[pixel]) {
+    fTime[pixel] = time;
+  }
+  fEdep[pixel] += edep;
+  fFlags[pixel] |= flags;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -29,8 +29,15 @@
 
 
 #include "B3PrimaryGeneratorAction.hh"
-
-#include "G4LogicalVolumeStore.hh"
+#include "B3aRunAction.hh"
+#include "B3PhaseSpace.hh"
+#include "B3ResponseBuilder.hh"
+#include "B3Checkpoint.hh"
+#include "B3Reproducibility.hh"
+
+#include "G4TransportationManager.hh"
+#include "G4Navigator.hh"
+#include "G4VPhysicalVolume.hh"
 #include "G4LogicalVolume.hh"
 #include "G4Box.hh"
 
@@ -46,8 +53,9 @@
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-B3PrimaryGeneratorAction::B3PrimaryGeneratorAction()
+B3PrimaryGeneratorAction::B3PrimaryGeneratorAction(B3aRunAction* runAction)
  : G4VUserPrimaryGeneratorAction(),
+   fRunAction(runAction),
    fParticleGun(0),
    fWorld(0)
 {
@@ -75,15 +83,32 @@ B3PrimaryGeneratorAction::~B3PrimaryGeneratorAction()
 
 void B3PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
 {
+  // already scored before the run was interrupted
+  if (B3Checkpoint::IsDone(anEvent->GetEventID())) return;
+  B3Reproducibility::SeedEvent(anEvent->GetEventID());
+
+  // the particles recorded at the patient surface
+  B3PhaseSpace* phaseSpace = fRunAction->GetPhaseSpace();
+  if (phaseSpace->IsReplaying()) {
+    phaseSpace->GeneratePrimaries(anEvent);
+    return;
+  }
+
+  // the photons of a response library build, into the crystal ring
+  B3ResponseBuilder* responseBuilder = fRunAction->GetResponseBuilder();
+  if (responseBuilder->IsEnabled()) {
+    responseBuilder->GeneratePrimaries(anEvent);
+    return;
+  }
 
   G4double WorldSizeXY = 0;
 
-  if (!fWorld)
-  {
-    G4LogicalVolume* WorldLV
-      = G4LogicalVolumeStore::GetInstance()->GetVolume("World");
-    if ( WorldLV ) fWorld = dynamic_cast<G4Box*>(WorldLV->GetSolid());
-  }
+  // looked up at each event: the world changes with the geometry
+  // parameters of /B3/det/...
+  G4VPhysicalVolume* worldPV = G4TransportationManager::GetTransportationManager()
+    ->GetNavigatorForTracking()->GetWorldVolume();
+  fWorld = worldPV ? dynamic_cast<G4Box*>(worldPV->GetLogicalVolume()->GetSolid())
+                   : 0;
 
   if ( fWorld ) {
     WorldSizeXY = fWorld->GetXHalfLength()*2.;
@@ -0,0 +1,189 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3Reproducibility.cc
+/// \brief Implementation of the B3Reproducibility class
+
+#include "B3Reproducibility.hh"
+#include "B3ReproducibilityMessenger.hh"
+#include "B3RunState.hh"
+
+#include "G4AutoLock.hh"
+#include "G4Run.hh"
+#include "Randomize.hh"
+
+#ifdef G4MULTITHREADED
+#include "G4MTRunManager.hh"
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+
+namespace
+{
+  // SplitMix64 finalizer: well-mixed 64 bits from consecutive inputs
+  std::uint64_t Mix(std::uint64_t x)
+  {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+  }
+}
+
+G4long  B3Reproducibility::fgRunSeed = 0;
+G4Mutex B3Reproducibility::fgMutex = G4MUTEX_INITIALIZER;
+std::multimap<G4int, std::string> B3Reproducibility::fgBlocks;
+G4bool  B3Reproducibility::fgOrdered = true;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3Reproducibility::B3Reproducibility()
+ : fEnabled(false),
+   fSeed(1),
+   fBlockSize(10000),
+   fBlock(-1),
+   fMessenger(0)
+{
+  fMessenger = new B3ReproducibilityMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3Reproducibility::~B3Reproducibility()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3Reproducibility::BeginOfRun(G4int runID, G4bool master)
+{
+  fBlock = -1;
+  if (!master) return;
+
+  fgRunSeed = 0;
+  fgBlocks.clear();
+  fgOrdered = true;
+  if (!fEnabled) return;
+
+  // positive and non-zero, 0 means disabled
+  fgRunSeed = G4long(Mix(Mix(fSeed) + runID) >> 2) + 1;
+
+#ifdef G4MULTITHREADED
+  // the workers take whole blocks of consecutive events, unless the run
+  // manager lowers the modulo to events/threads
+  if (G4Threading::IsMultithreadedApplication()) {
+    G4MTRunManager* runManager = G4MTRunManager::GetMasterRunManager();
+    G4int nbEvents
+      = runManager->GetCurrentRun()->GetNumberOfEventToBeProcessed();
+    G4int nbThreads = runManager->GetNumberOfThreads();
+    if (nbEvents > 0 && fBlockSize > nbEvents/nbThreads) {
+      G4ExceptionDescription msg;
+      msg << "Blocks of " << fBlockSize << " events cannot be handed out"
+          << " whole for " << nbEvents << " events on " << nbThreads
+          << " threads." << G4endl << "Set /B3/reproducible/blockSize to "
+          << std::max(nbEvents/nbThreads, 1) << " or less, the same for"
+          << " all the runs to compare.";
+      G4Exception("B3Reproducibility::BeginOfRun()", "MyCode0008",
+                  FatalException, msg);
+    }
+    runManager->SetEventModulo(fBlockSize);
+  }
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3Reproducibility::SeedEvent(G4int eventID)
+{
+  if (fgRunSeed == 0) return;
+
+  std::uint64_t x = Mix(std::uint64_t(fgRunSeed) ^
+                        (std::uint64_t(eventID) << 32));
+  std::uint64_t y = Mix(x);
+  // two 31-bit seeds, as the MT run manager hands out per event
+  long seeds[3] = { long(x % 2147483646) + 1, long(y % 2147483646) + 1, 0 };
+  G4Random::setTheSeeds(seeds, -1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3Reproducibility::BeginOfEvent(G4int eventID)
+{
+  if (!fEnabled) return;
+
+  G4int block = eventID/fBlockSize;
+  if (block == fBlock) return;
+  if (fBlock >= 0) Flush();
+  fBlock = block;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3Reproducibility::EndOfRun(G4bool master)
+{
+  if (!fEnabled) return;
+
+  // last block of a tracking thread
+  if (fBlock >= 0) Flush();
+  fBlock = -1;
+  if (!master) return;
+
+  // the workers are done: the master state is empty, add the blocks
+  G4AutoLock lock(&fgMutex);
+  if (!fgOrdered) {
+    G4ExceptionDescription msg;
+    msg << "The blocks of " << fBlockSize << " events were not processed"
+        << " by one thread each: the sums of this run are not reproducible."
+        << G4endl << "Was /run/eventModulo changed?";
+    G4Exception("B3Reproducibility::EndOfRun()", "MyCode0008",
+                JustWarning, msg);
+  }
+  std::multimap<G4int, std::string>::const_iterator it;
+  for (it = fgBlocks.begin(); it != fgBlocks.end(); ++it) {
+    std::istringstream block(it->second);
+    B3RunState::Add(block);
+  }
+  fgBlocks.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3Reproducibility::Flush()
+{
+  std::ostringstream block;
+  B3RunState::Save(block);
+  B3RunState::Reset();
+
+  // a block shared by several threads has no order to keep
+  G4AutoLock lock(&fgMutex);
+  if (fgBlocks.count(fBlock)) fgOrdered = false;
+  fgBlocks.insert(std::make_pair(fBlock, block.str()));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
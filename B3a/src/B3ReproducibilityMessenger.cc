@@ -0,0 +1,98 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3ReproducibilityMessenger.cc
+/// \brief Implementation of the B3ReproducibilityMessenger class
+
+#include "B3ReproducibilityMessenger.hh"
+#include "B3Reproducibility.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ReproducibilityMessenger::B3ReproducibilityMessenger(
+                                    B3Reproducibility* reproducibility)
+ : G4UImessenger(),
+   fReproducibility(reproducibility),
+   fDirectory(0),
+   fEnableCmd(0),
+   fSeedCmd(0),
+   fBlockSizeCmd(0)
+{
+  fDirectory = new G4UIdirectory("/B3/reproducible/");
+  fDirectory->SetGuidance("Results independent of the number of threads.");
+
+  fEnableCmd = new G4UIcmdWithABool("/B3/reproducible/enable",this);
+  fEnableCmd->SetGuidance("Seed each event from the run seed and its ID,");
+  fEnableCmd->SetGuidance("and sum the scores in the order of the events.");
+  fEnableCmd->SetParameterName("flag",true);
+  fEnableCmd->SetDefaultValue(true);
+  fEnableCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fSeedCmd = new G4UIcmdWithAnInteger("/B3/reproducible/seed",this);
+  fSeedCmd->SetGuidance("Seed of the runs, combined with the run ID.");
+  fSeedCmd->SetGuidance("Set by the --seed option of the program.");
+  fSeedCmd->SetParameterName("seed",false);
+  fSeedCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fBlockSizeCmd = new G4UIcmdWithAnInteger("/B3/reproducible/blockSize",this);
+  fBlockSizeCmd->SetGuidance("Number of consecutive events summed by one");
+  fBlockSizeCmd->SetGuidance("thread before they are added to the total.");
+  fBlockSizeCmd->SetParameterName("nbEvents",false);
+  fBlockSizeCmd->SetRange("nbEvents>0");
+  fBlockSizeCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ReproducibilityMessenger::~B3ReproducibilityMessenger()
+{
+  delete fEnableCmd;
+  delete fSeedCmd;
+  delete fBlockSizeCmd;
+  delete fDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ReproducibilityMessenger::SetNewValue(G4UIcommand* command,
+                                             G4String newValue)
+{
+  if ( command == fEnableCmd ) {
+    fReproducibility->SetEnabled(fEnableCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fSeedCmd ) {
+    fReproducibility->SetSeed(fSeedCmd->GetNewIntValue(newValue));
+  }
+  else if ( command == fBlockSizeCmd ) {
+    fReproducibility->SetBlockSize(fBlockSizeCmd->GetNewIntValue(newValue));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
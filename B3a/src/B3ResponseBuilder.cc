@@ -0,0 +1,202 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3ResponseBuilder.cc
+/// \brief Implementation of the B3ResponseBuilder class
+
+#include "B3ResponseBuilder.hh"
+#include "B3ResponseBuilderMessenger.hh"
+#include "B3DetectorConstruction.hh"
+#include "B3PixelSD.hh"
+
+#include "G4RunManager.hh"
+#include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4Gamma.hh"
+#include "G4AutoLock.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+
+G4Mutex B3ResponseBuilder::fgMutex = G4MUTEX_INITIALIZER;
+B3ResponseLibrary* B3ResponseBuilder::fgLibrary = 0;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ResponseBuilder::B3ResponseBuilder()
+ : fMaxEnergy(30.*keV),
+   fLibrary(0),
+   fReferenceRing(0),
+   fReferenceCrystal(0),
+   fMessenger(0)
+{
+  const G4int nbBins[B3ResponseLibrary::kNofAxes] = { 30, 4, 4, 3, 4 };
+  SetNbBins(nbBins);
+  fMessenger = new B3ResponseBuilderMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ResponseBuilder::~B3ResponseBuilder()
+{
+  delete fLibrary;
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ResponseBuilder::SetNbBins(
+                          const G4int nbBins[B3ResponseLibrary::kNofAxes])
+{
+  for (G4int k = 0; k < B3ResponseLibrary::kNofAxes; ++k) {
+    fNbBins[k] = nbBins[k];
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ResponseBuilder::BeginOfRun(G4bool master)
+{
+  delete fLibrary;
+  fLibrary = 0;
+  if (!IsEnabled()) return;
+
+  const B3DetectorConstruction* detector
+    = static_cast<const B3DetectorConstruction*>(
+        G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  if (master && !detector->GetResponseLibrary().empty()) {
+    G4Exception("B3ResponseBuilder::BeginOfRun()", "MyCode0012",
+                FatalException,
+                "A response library is built by the full simulation:"
+                " remove /B3/det/responseLibrary.");
+  }
+
+  fLibrary = new B3ResponseLibrary();
+  fLibrary->SetBinning(fNbBins, fMaxEnergy);
+  fLibrary->SetCell(detector);
+  fReferenceRing = detector->GetNbRings()/2;
+  fReferenceCrystal = detector->GetNbCrystals()/2;
+
+  if (master) {
+    G4AutoLock lock(&fgMutex);
+    delete fgLibrary;
+    fgLibrary = new B3ResponseLibrary();
+    fgLibrary->SetBinning(fNbBins, fMaxEnergy);
+    fgLibrary->SetCell(detector);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ResponseBuilder::GeneratePrimaries(G4Event* event)
+{
+  const B3DetectorConstruction* detector
+    = static_cast<const B3DetectorConstruction*>(
+        G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  G4int pixel = fReferenceRing*detector->GetNbCrystals() + fReferenceCrystal;
+
+  // face of the reference crystal: normal, across the crystals, along z
+  G4ThreeVector normal = detector->GetPixelDirection(pixel);
+  G4ThreeVector across(-normal.y(), normal.x(), 0.);
+  G4ThreeVector along(0., 0., 1.);
+
+  G4double values[B3ResponseLibrary::kNofAxes];
+  fLibrary->SampleInBin(event->GetEventID() % fLibrary->GetNbBins(), values);
+  G4double cosTheta = values[B3ResponseLibrary::kCosTheta];
+  G4double sinTheta = std::sqrt(std::max(1. - cosTheta*cosTheta, 0.));
+  G4double azimuth = values[B3ResponseLibrary::kAzimuth];
+  G4ThreeVector direction = cosTheta*normal + sinTheta*
+    (std::cos(azimuth)*across + std::sin(azimuth)*along);
+  G4ThreeVector entry = detector->GetPixelEntrance(pixel)
+                      + values[B3ResponseLibrary::kU]*across
+                      + values[B3ResponseLibrary::kV]*along;
+
+  // from just before the face
+  G4PrimaryVertex* vertex
+    = new G4PrimaryVertex(entry - 1.*um*direction, 0.);
+  G4PrimaryParticle* primary = new G4PrimaryParticle(G4Gamma::Gamma());
+  primary->SetKineticEnergy(values[B3ResponseLibrary::kEnergy]);
+  primary->SetMomentumDirection(direction);
+  vertex->SetPrimary(primary);
+  event->AddPrimaryVertex(vertex);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ResponseBuilder::EndOfEvent(const G4Event* event,
+                                   const B3PixelSD* pixelSD)
+{
+  if (!fLibrary || !event->GetPrimaryVertex()) return;
+
+  G4int bin = event->GetEventID() % fLibrary->GetNbBins();
+  G4double energy
+    = event->GetPrimaryVertex()->GetPrimary()->GetKineticEnergy();
+
+  G4int nbCrystals = pixelSD->GetNbCrystals();
+  const std::vector<G4int>& pixels = pixelSD->GetTouchedPixels();
+  std::vector<B3ResponseLibrary::Deposit> deposits;
+  for (size_t i = 0; i < pixels.size(); ++i) {
+    G4double edep = pixelSD->GetEdep(pixels[i]);
+    if (edep <= 0.) continue;
+    G4int dCrystal = pixelSD->GetCrystal(pixels[i]) - fReferenceCrystal;
+    if (dCrystal > nbCrystals/2)   dCrystal -= nbCrystals;
+    if (dCrystal < -nbCrystals/2)  dCrystal += nbCrystals;
+    B3ResponseLibrary::Deposit deposit;
+    deposit.dCrystal = dCrystal;
+    deposit.dRing = pixelSD->GetRing(pixels[i]) - fReferenceRing;
+    deposit.edep = (edep > 0.5*energy) ? G4float((edep - energy)/keV)
+                                       : G4float(edep/keV);
+    deposits.push_back(deposit);
+  }
+  fLibrary->AddOutcome(bin, deposits);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ResponseBuilder::EndOfRun(G4bool master, G4bool tracking)
+{
+  if (!fLibrary) return;
+
+  G4AutoLock lock(&fgMutex);
+  if (tracking) fgLibrary->Merge(*fLibrary);
+  if (!master) return;
+
+  if (fgLibrary->Write(fFileName)) {
+    G4cout << " Response library: " << fgLibrary->GetNbOutcomes()
+           << " outcomes in " << fgLibrary->GetNbBins()
+           << " bins written to " << fFileName << G4endl;
+  }
+  else {
+    G4ExceptionDescription msg;
+    msg << "Cannot write the response library " << fFileName << ".";
+    G4Exception("B3ResponseBuilder::EndOfRun()", "MyCode0012",
+                JustWarning, msg);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
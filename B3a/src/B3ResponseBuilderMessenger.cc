@@ -0,0 +1,111 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3ResponseBuilderMessenger.cc
+/// \brief Implementation of the B3ResponseBuilderMessenger class
+
+#include "B3ResponseBuilderMessenger.hh"
+#include "B3ResponseBuilder.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ResponseBuilderMessenger::B3ResponseBuilderMessenger(
+                                    B3ResponseBuilder* builder)
+ : G4UImessenger(),
+   fBuilder(builder),
+   fDirectory(0),
+   fBuildCmd(0),
+   fNbBinsCmd(0),
+   fMaxEnergyCmd(0)
+{
+  fDirectory = new G4UIdirectory("/B3/response/");
+  fDirectory->SetGuidance("Build of a detector response library.");
+
+  fBuildCmd = new G4UIcmdWithAString("/B3/response/build",this);
+  fBuildCmd->SetGuidance("Shoot the photons of the next runs into the");
+  fBuildCmd->SetGuidance("library bins and write it; none to stop.");
+  fBuildCmd->SetGuidance("Use as many events as bins times the outcomes");
+  fBuildCmd->SetGuidance("wanted per bin.");
+  fBuildCmd->SetParameterName("fileName",false);
+  fBuildCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fNbBinsCmd = new G4UIcommand("/B3/response/nbBins",this);
+  fNbBinsCmd->SetGuidance("Number of bins in energy, entry point across and");
+  fNbBinsCmd->SetGuidance("along the rings, cos(theta) and azimuth.");
+  const char* axes[5] = { "nE", "nU", "nV", "nCos", "nPhi" };
+  for (G4int i = 0; i < 5; ++i) {
+    G4UIparameter* parameter = new G4UIparameter(axes[i],'i',false);
+    parameter->SetParameterRange(G4String(axes[i]) + " > 0");
+    fNbBinsCmd->SetParameter(parameter);
+  }
+  fNbBinsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fMaxEnergyCmd = new G4UIcmdWithADoubleAndUnit("/B3/response/maxEnergy",this);
+  fMaxEnergyCmd->SetGuidance("Upper edge of the last energy bin.");
+  fMaxEnergyCmd->SetParameterName("emax",false);
+  fMaxEnergyCmd->SetRange("emax>0.");
+  fMaxEnergyCmd->SetUnitCategory("Energy");
+  fMaxEnergyCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ResponseBuilderMessenger::~B3ResponseBuilderMessenger()
+{
+  delete fBuildCmd;
+  delete fNbBinsCmd;
+  delete fMaxEnergyCmd;
+  delete fDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ResponseBuilderMessenger::SetNewValue(G4UIcommand* command,
+                                             G4String newValue)
+{
+  if ( command == fBuildCmd ) {
+    fBuilder->SetFileName(newValue == "none" ? G4String() : newValue);
+  }
+  else if ( command == fNbBinsCmd ) {
+    G4int nbBins[5] = { 1, 1, 1, 1, 1 };
+    std::istringstream is(newValue);
+    for (G4int i = 0; i < 5; ++i) is >> nbBins[i];
+    fBuilder->SetNbBins(nbBins);
+  }
+  else if ( command == fMaxEnergyCmd ) {
+    fBuilder->SetMaxEnergy(fMaxEnergyCmd->GetNewDoubleValue(newValue));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
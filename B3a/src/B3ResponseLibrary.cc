@@ -0,0 +1,343 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3ResponseLibrary.cc
+/// \brief Implementation of the B3ResponseLibrary class
+
+#include "B3ResponseLibrary.hh"
+#include "B3DetectorConstruction.hh"
+#include "B3RunState.hh"
+
+#include "G4Material.hh"
+#include "G4AutoLock.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+
+namespace
+{
+  const uint32_t kVersion = 1;
+
+  G4Mutex libraryMutex = G4MUTEX_INITIALIZER;
+  std::map<G4String, B3ResponseLibrary*> libraries;
+
+  // lower edge of each axis, in units of its range
+  const G4double kAxisMin[B3ResponseLibrary::kNofAxes]
+    = { 0., -0.5, -0.5, 0., 0. };
+
+  template <typename T>
+  void Put(std::ostream& output, const T& value)
+  {
+    output.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template <typename T>
+  G4bool Get(std::istream& input, T& value)
+  {
+    return bool(input.read(reinterpret_cast<char*>(&value), sizeof(T)));
+  }
+
+  template <typename T>
+  void PutArray(std::ostream& output, const std::vector<T>& values)
+  {
+    if (!values.empty()) {
+      output.write(reinterpret_cast<const char*>(&values[0]),
+                   values.size()*sizeof(T));
+    }
+  }
+
+  template <typename T>
+  G4bool GetArray(std::istream& input, std::vector<T>& values, size_t size)
+  {
+    values.resize(size);
+    return size == 0 ||
+           input.read(reinterpret_cast<char*>(&values[0]), size*sizeof(T));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ResponseLibrary::B3ResponseLibrary()
+ : fMaxEnergy(30.*keV),
+   fPitchU(0.),
+   fPitchV(0.),
+   fThickness(0.),
+   fGap(0.),
+   fNbCrystals(0)
+{
+  const G4int nbBins[kNofAxes] = { 30, 4, 4, 3, 4 };
+  SetBinning(nbBins, fMaxEnergy);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ResponseLibrary::~B3ResponseLibrary()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ResponseLibrary::SetBinning(const G4int nbBins[kNofAxes],
+                                   G4double maxEnergy)
+{
+  for (G4int k = 0; k < kNofAxes; ++k) fNbBins[k] = std::max(nbBins[k], 1);
+  fMaxEnergy = maxEnergy;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ResponseLibrary::SetCell(const B3DetectorConstruction* detector)
+{
+  fPitchU = detector->GetCrystalDY();
+  fPitchV = detector->GetCrystalDX();
+  fThickness = detector->GetCrystalDZ();
+  fGap = detector->GetGap();
+  fNbCrystals = detector->GetNbCrystals();
+  fMaterial = detector->GetCrystalMaterial()
+            ? detector->GetCrystalMaterial()->GetName() : G4String();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3ResponseLibrary::MatchesCell(
+                            const B3DetectorConstruction* detector) const
+{
+  B3ResponseLibrary current;
+  current.SetCell(detector);
+  const G4double tolerance = 1.*um;
+  return std::abs(current.fPitchU - fPitchU) < tolerance &&
+         std::abs(current.fPitchV - fPitchV) < tolerance &&
+         std::abs(current.fThickness - fThickness) < tolerance &&
+         std::abs(current.fGap - fGap) < tolerance &&
+         current.fNbCrystals == fNbCrystals &&
+         current.fMaterial == fMaterial;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int B3ResponseLibrary::GetNbBins() const
+{
+  G4int nbBins = 1;
+  for (G4int k = 0; k < kNofAxes; ++k) nbBins *= fNbBins[k];
+  return nbBins;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int B3ResponseLibrary::GetBin(G4double energy, G4double u, G4double v,
+                                G4double cosTheta, G4double azimuth) const
+{
+  // each axis scaled to [min, min + 1)
+  const G4double values[kNofAxes] = {
+    energy/fMaxEnergy, u/fPitchU, v/fPitchV, cosTheta,
+    (azimuth < 0. ? azimuth + twopi : azimuth)/twopi };
+
+  // the energy, first axis, varies fastest
+  G4int bin = 0;
+  for (G4int k = kNofAxes - 1; k >= 0; --k) {
+    G4int index = G4int(std::floor((values[k] - kAxisMin[k])*fNbBins[k]));
+    // the edges of the cell and of the angles belong to the last bin
+    if (index == fNbBins[k] && k != kEnergy) index = fNbBins[k] - 1;
+    if (index < 0 || index >= fNbBins[k]) return -1;
+    bin = bin*fNbBins[k] + index;
+  }
+  return bin;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ResponseLibrary::SampleInBin(G4int bin,
+                                    G4double values[kNofAxes]) const
+{
+  for (G4int k = 0; k < kNofAxes; ++k) {
+    G4int index = bin % fNbBins[k];
+    bin /= fNbBins[k];
+    values[k] = kAxisMin[k] + (index + G4UniformRand())/fNbBins[k];
+  }
+  values[kEnergy]   *= fMaxEnergy;
+  values[kU]        *= fPitchU;
+  values[kV]        *= fPitchV;
+  values[kAzimuth]  *= twopi;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ResponseLibrary::AddOutcome(G4int bin,
+                                   const std::vector<Deposit>& deposits)
+{
+  if (fOutcomeStart.empty()) fOutcomeStart.push_back(0);
+  fOutcomeBin.push_back(bin);
+  fDeposits.insert(fDeposits.end(), deposits.begin(), deposits.end());
+  fOutcomeStart.push_back(fDeposits.size());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ResponseLibrary::Merge(const B3ResponseLibrary& other)
+{
+  for (size_t i = 0; i < other.fOutcomeBin.size(); ++i) {
+    std::vector<Deposit> deposits(
+      other.fDeposits.begin() + other.fOutcomeStart[i],
+      other.fDeposits.begin() + other.fOutcomeStart[i+1]);
+    AddOutcome(other.fOutcomeBin[i], deposits);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const B3ResponseLibrary::Deposit*
+B3ResponseLibrary::Sample(G4int bin, size_t& nbDeposits) const
+{
+  nbDeposits = 0;
+  std::uint64_t first = fBinStart[bin];
+  std::uint64_t nbOutcomes = fBinStart[bin+1] - first;
+  if (nbOutcomes == 0) return 0;
+
+  std::uint64_t outcome
+    = first + std::min(std::uint64_t(G4UniformRand()*nbOutcomes),
+                       nbOutcomes - 1);
+  nbDeposits = fOutcomeStart[outcome+1] - fOutcomeStart[outcome];
+  return nbDeposits ? &fDeposits[fOutcomeStart[outcome]] : 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3ResponseLibrary::Write(const G4String& fileName) const
+{
+  // outcomes grouped by bin, in the order they were added
+  const G4int nbBins = GetNbBins();
+  std::vector<std::uint64_t> binStart(nbBins + 1, 0);
+  for (size_t i = 0; i < fOutcomeBin.size(); ++i) ++binStart[fOutcomeBin[i]+1];
+  for (G4int bin = 0; bin < nbBins; ++bin) binStart[bin+1] += binStart[bin];
+
+  std::vector<size_t> order(fOutcomeBin.size());
+  std::vector<std::uint64_t> next(binStart.begin(), binStart.end() - 1);
+  for (size_t i = 0; i < fOutcomeBin.size(); ++i) {
+    order[next[fOutcomeBin[i]]++] = i;
+  }
+  std::vector<std::uint64_t> outcomeStart(1, 0);
+  std::vector<Deposit> deposits;
+  deposits.reserve(fDeposits.size());
+  for (size_t j = 0; j < order.size(); ++j) {
+    size_t i = order[j];
+    deposits.insert(deposits.end(), fDeposits.begin() + fOutcomeStart[i],
+                    fDeposits.begin() + fOutcomeStart[i+1]);
+    outcomeStart.push_back(deposits.size());
+  }
+
+  std::ofstream output(fileName, std::ios::binary);
+  output.write("B3RL", 4);
+  Put(output, kVersion);
+  for (G4int k = 0; k < kNofAxes; ++k) Put(output, fNbBins[k]);
+  Put(output, fMaxEnergy/keV);
+  Put(output, fPitchU/mm);
+  Put(output, fPitchV/mm);
+  Put(output, fThickness/mm);
+  Put(output, fGap/mm);
+  Put(output, fNbCrystals);
+  B3RunState::WriteString(output, fMaterial);
+  Put(output, std::uint64_t(order.size()));
+  Put(output, std::uint64_t(deposits.size()));
+  PutArray(output, binStart);
+  PutArray(output, outcomeStart);
+  PutArray(output, deposits);
+  return output.good();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3ResponseLibrary::Read(const G4String& fileName)
+{
+  std::ifstream input(fileName, std::ios::binary);
+  char magic[4];
+  uint32_t version;
+  if (!input.read(magic, 4) || G4String(magic, 4) != "B3RL" ||
+      !Get(input, version) || version != kVersion) return false;
+
+  G4bool ok = true;
+  for (G4int k = 0; k < kNofAxes; ++k) {
+    ok = ok && Get(input, fNbBins[k]) && fNbBins[k] > 0;
+  }
+  G4double values[5];
+  for (G4int k = 0; k < 5; ++k) ok = ok && Get(input, values[k]);
+  std::string material;
+  std::uint64_t nbOutcomes = 0, nbDeposits = 0;
+  ok = ok && Get(input, fNbCrystals) &&
+       B3RunState::ReadString(input, material) &&
+       Get(input, nbOutcomes) && Get(input, nbDeposits);
+  if (!ok) return false;
+  fMaxEnergy = values[0]*keV;
+  fPitchU = values[1]*mm;
+  fPitchV = values[2]*mm;
+  fThickness = values[3]*mm;
+  fGap = values[4]*mm;
+  fMaterial = material;
+
+  ok = GetArray(input, fBinStart, GetNbBins() + 1) &&
+       GetArray(input, fOutcomeStart, nbOutcomes + 1) &&
+       GetArray(input, fDeposits, nbDeposits) &&
+       fBinStart.back() == nbOutcomes && fOutcomeStart.back() == nbDeposits;
+  if (!ok) return false;
+
+  fOutcomeBin.resize(nbOutcomes);
+  for (G4int bin = 0; bin < GetNbBins(); ++bin) {
+    for (std::uint64_t i = fBinStart[bin]; i < fBinStart[bin+1]; ++i) {
+      fOutcomeBin[i] = bin;
+    }
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const B3ResponseLibrary* B3ResponseLibrary::Load(const G4String& fileName)
+{
+  G4AutoLock lock(&libraryMutex);
+  std::map<G4String, B3ResponseLibrary*>::iterator it
+    = libraries.find(fileName);
+  if (it != libraries.end()) return it->second;
+
+  B3ResponseLibrary* library = new B3ResponseLibrary();
+  if (!library->Read(fileName)) {
+    delete library;
+    G4ExceptionDescription msg;
+    msg << "Cannot read the response library " << fileName << ".";
+    G4Exception("B3ResponseLibrary::Load()", "MyCode0012",
+                FatalException, msg);
+    return 0;
+  }
+  G4cout << " Response library " << fileName << ": "
+         << library->GetNbOutcomes() << " outcomes in "
+         << library->GetNbBins() << " bins" << G4endl;
+  libraries[fileName] = library;
+  return library;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
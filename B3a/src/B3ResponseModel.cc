@@ -0,0 +1,159 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3ResponseModel.cc
+/// \brief Implementation of the B3ResponseModel class
+
+#include "B3ResponseModel.hh"
+#include "B3ResponseLibrary.hh"
+#include "B3DetectorConstruction.hh"
+#include "B3PixelSD.hh"
+#include "B3TrackOrigin.hh"
+
+#include "G4FastTrack.hh"
+#include "G4FastStep.hh"
+#include "G4Gamma.hh"
+#include "G4Region.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ResponseModel::B3ResponseModel(const B3ResponseLibrary* library,
+                                 const B3DetectorConstruction* detector,
+                                 B3PixelSD* pixelSD, G4Region* envelope)
+ : G4VFastSimulationModel("B3ResponseModel", envelope),
+   fLibrary(library),
+   fPixelSD(pixelSD),
+   fNbCrystals(detector->GetNbCrystals()),
+   fNbRings(detector->GetNbRings()),
+   fInnerRadius(detector->GetRingInnerRadius()),
+   fPitchU(detector->GetCrystalDY()),
+   fPitchV(detector->GetCrystalDX()),
+   fBin(-1),
+   fCrystal(0),
+   fRing(0),
+   fFlightLength(0.)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ResponseModel::~B3ResponseModel()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3ResponseModel::IsApplicable(const G4ParticleDefinition& particle)
+{
+  return &particle == G4Gamma::Gamma();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3ResponseModel::ModelTrigger(const G4FastTrack& fastTrack)
+{
+  fBin = -1;
+
+  // the envelope is centred and not rotated: local is global
+  const G4ThreeVector position = fastTrack.GetPrimaryTrackLocalPosition();
+  const G4ThreeVector direction = fastTrack.GetPrimaryTrackLocalDirection();
+
+  // only on the inner surface, going out
+  if (std::fabs(position.perp() - fInnerRadius) > 1.*um) return false;
+  if (position.x()*direction.x() + position.y()*direction.y() <= 0.)
+    return false;
+
+  // crystal around the azimuth of the entry, then its neighbour if the
+  // photon reaches the plane of the face beyond its edge
+  const G4double dPhi = twopi/fNbCrystals;
+  G4int crystal = G4int(std::floor(position.phi()/dPhi + 0.5));
+  G4ThreeVector normal, across, entry;
+  G4double length = 0., u = 0.;
+  for (G4int attempt = 0; attempt < 2; ++attempt) {
+    crystal = (crystal % fNbCrystals + fNbCrystals) % fNbCrystals;
+    normal.set(std::cos(crystal*dPhi), std::sin(crystal*dPhi), 0.);
+    across.set(-normal.y(), normal.x(), 0.);
+    G4double cosTheta = normal.dot(direction);
+    if (cosTheta <= 0.) return false;
+    length = (fInnerRadius - normal.dot(position))/cosTheta;
+    entry = position + length*direction;
+    u = entry.dot(across);
+    if (std::fabs(u) <= 0.5*fPitchU) break;
+    if (attempt == 1) return false;
+    crystal += (u > 0.) ? 1 : -1;
+  }
+
+  G4int ring = G4int(std::floor(entry.z()/fPitchV + 0.5*fNbRings));
+  if (ring < 0 || ring >= fNbRings) return false;
+  if (ring == fNbRings/2 && crystal == 0) return false;    // beam hole
+  G4double v = entry.z() - (ring + 0.5 - 0.5*fNbRings)*fPitchV;
+
+  G4double azimuth = std::atan2(direction.z(), direction.dot(across));
+  fBin = fLibrary->GetBin(fastTrack.GetPrimaryTrack()->GetKineticEnergy(),
+                          u, v, normal.dot(direction), azimuth);
+  fCrystal = crystal;
+  fRing = ring;
+  fFlightLength = length;
+  return fBin >= 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ResponseModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep)
+{
+  const G4Track* track = fastTrack.GetPrimaryTrack();
+  const G4double energy = track->GetKineticEnergy();
+  const G4double time = track->GetGlobalTime() + fFlightLength/c_light;
+  const G4int flags = B3TrackOrigin::Instance()->GetFlags(track->GetTrackID());
+
+  size_t nbDeposits = 0;
+  const B3ResponseLibrary::Deposit* deposits
+    = fLibrary->Sample(fBin, nbDeposits);
+
+  G4double total = 0.;
+  for (size_t i = 0; i < nbDeposits; ++i) {
+    G4int ring = fRing + deposits[i].dRing;
+    if (ring < 0 || ring >= fNbRings) continue;
+    G4int crystal = (fCrystal + deposits[i].dCrystal + fNbCrystals)
+                    % fNbCrystals;
+    if (ring == fNbRings/2 && crystal == 0) continue;
+
+    G4double edep = deposits[i].edep*keV;
+    if (edep <= 0.) edep = std::max(energy + edep, 0.);
+    if (edep == 0.) continue;
+    fPixelSD->AddDeposit(ring*fNbCrystals + crystal, edep, time, flags);
+    total += edep;
+  }
+
+  fastStep.KillPrimaryTrack();
+  fastStep.ProposePrimaryTrackPathLength(fFlightLength);
+  fastStep.ProposeTotalEnergyDeposited(total);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,275 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3RunState.cc
+/// \brief Implementation of the B3RunState class
+
+#include "B3RunState.hh"
+#include "B3HistoryTally.hh"
+#include "B3CountTally.hh"
+#include "B3Analysis.hh"
+
+#include "G4AccumulableManager.hh"
+#include "G4Accumulable.hh"
+
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace
+{
+  enum AccumulableType { kInt = 1, kDouble, kHistoryTally, kCountTally };
+
+  template <typename T>
+  void WriteVector(std::ostream& output, const std::vector<T>& data)
+  {
+    G4long size = data.size();
+    output.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    if (size) output.write(reinterpret_cast<const char*>(&data[0]),
+                           size*sizeof(T));
+  }
+
+  // adds the saved values, of the same size, to data
+  template <typename T>
+  G4bool AddVector(std::istream& input, std::vector<T>& data)
+  {
+    G4long size = 0;
+    if (!input.read(reinterpret_cast<char*>(&size), sizeof(size)) ||
+        size_t(size) != data.size()) return false;
+    if (size == 0) return true;
+    std::vector<T> saved(size);
+    if (!input.read(reinterpret_cast<char*>(&saved[0]), size*sizeof(T))) {
+      return false;
+    }
+    for (size_t i = 0; i < data.size(); ++i) data[i] += saved[i];
+    return true;
+  }
+
+  // bin contents of the tools histograms, with under- and overflows
+  template <typename H>
+  void SaveHisto(std::ostream& output, const H& histo)
+  {
+    typename H::hd_t data = histo.get_histo_data();
+    output.write(reinterpret_cast<const char*>(&data.m_all_entries),
+                 sizeof(data.m_all_entries));
+    WriteVector(output, data.m_bin_entries);
+    WriteVector(output, data.m_bin_Sw);
+    WriteVector(output, data.m_bin_Sw2);
+    for (size_t i = 0; i < data.m_bin_Sxw.size(); ++i) {
+      WriteVector(output, data.m_bin_Sxw[i]);
+      WriteVector(output, data.m_bin_Sx2w[i]);
+    }
+  }
+
+  template <typename H>
+  G4bool AddHisto(std::istream& input, H& histo)
+  {
+    typename H::hd_t data = histo.get_histo_data();
+    unsigned int allEntries = 0;
+    if (!input.read(reinterpret_cast<char*>(&allEntries), sizeof(allEntries))) {
+      return false;
+    }
+    data.m_all_entries += allEntries;
+    G4bool ok = AddVector(input, data.m_bin_entries)
+             && AddVector(input, data.m_bin_Sw)
+             && AddVector(input, data.m_bin_Sw2);
+    for (size_t i = 0; ok && i < data.m_bin_Sxw.size(); ++i) {
+      ok = AddVector(input, data.m_bin_Sxw[i])
+        && AddVector(input, data.m_bin_Sx2w[i]);
+    }
+    if (ok) histo.copy_from_data(data);
+    return ok;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3RunState::Save(std::ostream& output)
+{
+  SaveAccumulables(output);
+  SaveHistograms(output);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3RunState::Add(std::istream& input)
+{
+  return AddAccumulables(input) && AddHistograms(input);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3RunState::Reset()
+{
+  G4AccumulableManager::Instance()->Reset();
+
+  auto analysisManager = G4AnalysisManager::Instance();
+  for (G4int id = 0; id < analysisManager->GetNofH1s(); ++id) {
+    analysisManager->GetH1(id)->reset();
+  }
+  for (G4int id = 0; id < analysisManager->GetNofH2s(); ++id) {
+    analysisManager->GetH2(id)->reset();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3RunState::WriteString(std::ostream& output, const std::string& text)
+{
+  G4long size = text.size();
+  output.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  output.write(text.data(), size);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3RunState::ReadString(std::istream& input, std::string& text)
+{
+  G4long size = 0;
+  if (!input.read(reinterpret_cast<char*>(&size), sizeof(size))) return false;
+  text.assign(size, ' ');
+  return size == 0 || input.read(&text[0], size);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3RunState::SaveAccumulables(std::ostream& output)
+{
+  G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
+  G4int nofAccumulables = accumulableManager->GetNofAccumulables();
+  output.write(reinterpret_cast<const char*>(&nofAccumulables),
+               sizeof(nofAccumulables));
+
+  for (G4int id = 0; id < nofAccumulables; ++id) {
+    G4VAccumulable* accumulable = accumulableManager->GetAccumulable(id);
+    WriteString(output, accumulable->GetName());
+
+    G4int type = 0;
+    if (dynamic_cast<G4Accumulable<G4int>*>(accumulable))         type = kInt;
+    else if (dynamic_cast<G4Accumulable<G4double>*>(accumulable)) type = kDouble;
+    else if (dynamic_cast<B3HistoryTally*>(accumulable))    type = kHistoryTally;
+    else if (dynamic_cast<B3CountTally*>(accumulable))      type = kCountTally;
+    output.write(reinterpret_cast<const char*>(&type), sizeof(type));
+
+    if (type == kInt) {
+      G4int value = static_cast<G4Accumulable<G4int>*>(accumulable)->GetValue();
+      output.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+    else if (type == kDouble) {
+      G4double value =
+        static_cast<G4Accumulable<G4double>*>(accumulable)->GetValue();
+      output.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+    else if (type == kHistoryTally) {
+      static_cast<B3HistoryTally*>(accumulable)->Save(output);
+    }
+    else if (type == kCountTally) {
+      static_cast<B3CountTally*>(accumulable)->Save(output);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3RunState::AddAccumulables(std::istream& input)
+{
+  G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
+  G4int nofAccumulables = 0;
+  if (!input.read(reinterpret_cast<char*>(&nofAccumulables),
+                  sizeof(nofAccumulables))) return false;
+
+  for (G4int id = 0; id < nofAccumulables; ++id) {
+    std::string name;
+    G4int type = 0;
+    if (!ReadString(input, name) ||
+        !input.read(reinterpret_cast<char*>(&type), sizeof(type))) {
+      return false;
+    }
+    G4VAccumulable* accumulable = accumulableManager->GetAccumulable(name);
+    if (!accumulable) return false;
+
+    if (type == kInt) {
+      G4int value = 0;
+      input.read(reinterpret_cast<char*>(&value), sizeof(value));
+      *static_cast<G4Accumulable<G4int>*>(accumulable) += value;
+    }
+    else if (type == kDouble) {
+      G4double value = 0.;
+      input.read(reinterpret_cast<char*>(&value), sizeof(value));
+      *static_cast<G4Accumulable<G4double>*>(accumulable) += value;
+    }
+    else if (type == kHistoryTally) {
+      if (!static_cast<B3HistoryTally*>(accumulable)->Restore(input)) {
+        return false;
+      }
+    }
+    else if (type == kCountTally) {
+      if (!static_cast<B3CountTally*>(accumulable)->Restore(input)) {
+        return false;
+      }
+    }
+    if (!input) return false;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3RunState::SaveHistograms(std::ostream& output)
+{
+  auto analysisManager = G4AnalysisManager::Instance();
+  G4int nofH1s = analysisManager->GetNofH1s();
+  G4int nofH2s = analysisManager->GetNofH2s();
+  output.write(reinterpret_cast<const char*>(&nofH1s), sizeof(nofH1s));
+  for (G4int id = 0; id < nofH1s; ++id) {
+    SaveHisto(output, *analysisManager->GetH1(id));
+  }
+  output.write(reinterpret_cast<const char*>(&nofH2s), sizeof(nofH2s));
+  for (G4int id = 0; id < nofH2s; ++id) {
+    SaveHisto(output, *analysisManager->GetH2(id));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool B3RunState::AddHistograms(std::istream& input)
+{
+  auto analysisManager = G4AnalysisManager::Instance();
+  G4int nofH1s = 0, nofH2s = 0;
+  if (!input.read(reinterpret_cast<char*>(&nofH1s), sizeof(nofH1s)) ||
+      nofH1s != analysisManager->GetNofH1s()) return false;
+  for (G4int id = 0; id < nofH1s; ++id) {
+    if (!AddHisto(input, *analysisManager->GetH1(id))) return false;
+  }
+  if (!input.read(reinterpret_cast<char*>(&nofH2s), sizeof(nofH2s)) ||
+      nofH2s != analysisManager->GetNofH2s()) return false;
+  for (G4int id = 0; id < nofH2s; ++id) {
+    if (!AddHisto(input, *analysisManager->GetH2(id))) return false;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
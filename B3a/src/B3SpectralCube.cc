@@ -0,0 +1,92 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3SpectralCube.cc
+/// \brief Implementation of the B3SpectralCube class
+
+#include "B3SpectralCube.hh"
+#include "B3SpectralCubeMessenger.hh"
+#include "B3DetectorConstruction.hh"
+#include "B3Npy.hh"
+
+#include "G4RunManager.hh"
+#include "G4AccumulableManager.hh"
+#include "G4SystemOfUnits.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3SpectralCube::B3SpectralCube()
+ : fEnabled(false),
+   fNbBins(1000),
+   fMaxEnergy(25.*keV),
+   fNbRings(0),
+   fNbCrystals(0),
+   fCounts("SpectralCube"),
+   fMessenger(0)
+{
+  G4AccumulableManager::Instance()->RegisterAccumulable(&fCounts);
+
+  fMessenger = new B3SpectralCubeMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3SpectralCube::~B3SpectralCube()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3SpectralCube::BeginOfRun()
+{
+  if (!fEnabled) return;
+
+  const B3DetectorConstruction* detector
+    = static_cast<const B3DetectorConstruction*>(
+        G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  fNbRings    = detector->GetNbRings();
+  fNbCrystals = detector->GetNbCrystals();
+  fCounts.SetSize(size_t(fNbRings)*fNbCrystals*fNbBins);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3SpectralCube::Write(const G4String& fileName) const
+{
+  if (!fEnabled || fCounts.GetSize() == 0) return;
+
+  std::vector<size_t> shape;
+  shape.push_back(fNbRings);
+  shape.push_back(fNbCrystals);
+  shape.push_back(fNbBins);
+  if (B3Npy::Write(fileName, shape, &fCounts.GetCounts()[0])) {
+    G4cout << " Spectral cube written to " << fileName << ": "
+           << fNbBins << " bins up to " << fMaxEnergy/keV << " keV" << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,98 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3SpectralCubeMessenger.cc
+/// \brief Implementation of the B3SpectralCubeMessenger class
+
+#include "B3SpectralCubeMessenger.hh"
+#include "B3SpectralCube.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3SpectralCubeMessenger::B3SpectralCubeMessenger(
+                                    B3SpectralCube* spectralCube)
+ : G4UImessenger(),
+   fSpectralCube(spectralCube),
+   fDirectory(0),
+   fEnableCmd(0),
+   fNbBinsCmd(0),
+   fMaxEnergyCmd(0)
+{
+  fDirectory = new G4UIdirectory("/B3/cube/");
+  fDirectory->SetGuidance("Spectral cube of the pixel deposits.");
+
+  fEnableCmd = new G4UIcmdWithABool("/B3/cube/enable",this);
+  fEnableCmd->SetGuidance("Count the deposits per pixel and energy bin.");
+  fEnableCmd->SetParameterName("flag",true);
+  fEnableCmd->SetDefaultValue(true);
+  fEnableCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fNbBinsCmd = new G4UIcmdWithAnInteger("/B3/cube/nbBins",this);
+  fNbBinsCmd->SetGuidance("Number of energy bins of the cube.");
+  fNbBinsCmd->SetParameterName("nbBins",false);
+  fNbBinsCmd->SetRange("nbBins>0");
+  fNbBinsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fMaxEnergyCmd = new G4UIcmdWithADoubleAndUnit("/B3/cube/maxEnergy",this);
+  fMaxEnergyCmd->SetGuidance("Upper edge of the last energy bin.");
+  fMaxEnergyCmd->SetParameterName("emax",false);
+  fMaxEnergyCmd->SetRange("emax>0.");
+  fMaxEnergyCmd->SetUnitCategory("Energy");
+  fMaxEnergyCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3SpectralCubeMessenger::~B3SpectralCubeMessenger()
+{
+  delete fEnableCmd;
+  delete fNbBinsCmd;
+  delete fMaxEnergyCmd;
+  delete fDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3SpectralCubeMessenger::SetNewValue(G4UIcommand* command,
+                                             G4String newValue)
+{
+  if ( command == fEnableCmd ) {
+    fSpectralCube->SetEnabled(fEnableCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fNbBinsCmd ) {
+    fSpectralCube->SetNbBins(fNbBinsCmd->GetNewIntValue(newValue));
+  }
+  else if ( command == fMaxEnergyCmd ) {
+    fSpectralCube->SetMaxEnergy(fMaxEnergyCmd->GetNewDoubleValue(newValue));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -28,6 +28,7 @@
 /// \brief Implementation of the B3StackingAction class
 
 #include "B3StackingAction.hh"
+#include "B3TrackOrigin.hh"
 
 #include "G4Track.hh"
 #include "G4NeutrinoE.hh"
@@ -47,6 +48,9 @@ B3StackingAction::~B3StackingAction()
 G4ClassificationOfNewTrack
 B3StackingAction::ClassifyNewTrack(const G4Track* track)
 {
+  //provenance of the energy deposits
+  B3TrackOrigin::Instance()->Tag(track);
+
   //keep primary particle
   if (track->GetParentID() == 0) return fUrgent;
 
@@ -56,3 +60,10 @@ B3StackingAction::ClassifyNewTrack(const G4Track* track)
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3StackingAction::PrepareNewEvent()
+{
+  B3TrackOrigin::Instance()->Clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,257 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3StepProfiler.cc
+/// \brief Implementation of the B3StepProfiler class
+
+#include "B3StepProfiler.hh"
+#include "B3StepProfilerMessenger.hh"
+
+#include "G4AutoLock.hh"
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4VProcess.hh"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace
+{
+  // 24 bits of volume, 24 of particle, 16 of process type and subtype;
+  // the +1 keeps the key of a valid step non-zero
+  std::uint64_t MakeKey(G4int volume, G4int particle, G4int process)
+  {
+    return (std::uint64_t(volume + 1) << 40)
+         | (std::uint64_t(particle & 0xffffff) << 16)
+         | std::uint64_t(process & 0xffff);
+  }
+
+  size_t Hash(std::uint64_t key)
+  {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return size_t(key);
+  }
+}
+
+G4Mutex B3StepProfiler::fgMutex = G4MUTEX_INITIALIZER;
+std::map<std::vector<G4String>, B3StepProfiler::Totals>
+  B3StepProfiler::fgTotals;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3StepProfiler::B3StepProfiler()
+ : fEnabled(false),
+   fSamplingPeriod(16),
+   fNbRows(30),
+   fNofEntries(0),
+   fStepCounter(0),
+   fMessenger(0)
+{
+  fMessenger = new B3StepProfilerMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3StepProfiler::~B3StepProfiler()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3StepProfiler::SetSamplingPeriod(G4int period)
+{
+  fSamplingPeriod = std::max(period, 1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3StepProfiler::BeginOfRun(G4bool master)
+{
+  Entry empty = { 0, 0, 0, 0., 0, 0, 0 };
+  fTable.assign(fEnabled ? 1024 : 0, empty);
+  fNofEntries = 0;
+  fStepCounter = 0;
+  fTimingStart = Clock::now();
+  if (master) fgTotals.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3StepProfiler::Count(const G4Step* step)
+{
+  // the sampled step started at the end of the previous step action, or
+  // at the start of its track (StartTrack) if that came later
+  G4bool sampled = ++fStepCounter % fSamplingPeriod == 0;
+  Clock::time_point now;
+  if (sampled) now = Clock::now();
+
+  Entry& entry = Find(step);
+  ++entry.nofSteps;
+  if (step->GetTrack()->GetCurrentStepNumber() == 1) ++entry.nofTracks;
+
+  if (sampled) {
+    std::chrono::duration<G4double> elapsed = now - fTimingStart;
+    entry.time += elapsed.count()*fSamplingPeriod;
+  }
+  // the next step is sampled: it starts here, unless a track starts first
+  if ((fStepCounter + 1) % fSamplingPeriod == 0) {
+    fTimingStart = Clock::now();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3StepProfiler::Entry& B3StepProfiler::Find(const G4Step* step)
+{
+  const G4LogicalVolume* volume =
+    step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume();
+  const G4ParticleDefinition* particle =
+    step->GetTrack()->GetParticleDefinition();
+  const G4VProcess* process =
+    step->GetPostStepPoint()->GetProcessDefinedStep();
+  G4int processID = process ? (process->GetProcessType() << 12)
+                              | (process->GetProcessSubType() & 0xfff)
+                            : 0xffff;
+  std::uint64_t key = MakeKey(volume->GetInstanceID(),
+                              particle->GetInstanceID(), processID);
+
+  // linear probing in a power-of-two table, at most half full
+  size_t mask = fTable.size() - 1;
+  for (size_t i = Hash(key) & mask; ; i = (i + 1) & mask) {
+    Entry& entry = fTable[i];
+    if (entry.key == key) return entry;
+    if (entry.key == 0) {
+      if (2*(fNofEntries + 1) > fTable.size()) {
+        Grow();
+        return Find(step);
+      }
+      entry.key = key;
+      entry.volume = volume;
+      entry.particle = particle;
+      entry.process = process;
+      ++fNofEntries;
+      return entry;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3StepProfiler::Grow()
+{
+  std::vector<Entry> old;
+  old.swap(fTable);
+  Entry empty = { 0, 0, 0, 0., 0, 0, 0 };
+  fTable.assign(2*old.size(), empty);
+  size_t mask = fTable.size() - 1;
+  for (size_t k = 0; k < old.size(); ++k) {
+    if (old[k].key == 0) continue;
+    size_t i = Hash(old[k].key) & mask;
+    while (fTable[i].key != 0) i = (i + 1) & mask;
+    fTable[i] = old[k];
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3StepProfiler::EndOfRun(G4bool tracking)
+{
+  if (!fEnabled || !tracking) return;
+
+  // the names are taken on the thread owning the processes
+  {
+    G4AutoLock lock(&fgMutex);
+    for (size_t i = 0; i < fTable.size(); ++i) {
+      const Entry& entry = fTable[i];
+      if (entry.key == 0) continue;
+      std::vector<G4String> names(3);
+      names[0] = entry.volume->GetName();
+      names[1] = entry.particle->GetParticleName();
+      names[2] = entry.process ? entry.process->GetProcessName()
+                               : G4String("none");
+      Totals& totals = fgTotals[names];
+      totals.nofSteps  += entry.nofSteps;
+      totals.nofTracks += entry.nofTracks;
+      totals.time      += entry.time;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3StepProfiler::Report() const
+{
+  if (!fEnabled) return;
+
+  typedef std::pair<std::vector<G4String>, Totals> Row;
+  std::vector<Row> rows(fgTotals.begin(), fgTotals.end());
+  std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b)
+            { return a.second.time > b.second.time; });
+
+  G4double time = 0.;
+  G4long nofSteps = 0;
+  for (size_t i = 0; i < rows.size(); ++i) {
+    time += rows[i].second.time;
+    nofSteps += rows[i].second.nofSteps;
+  }
+  if (nofSteps == 0) return;
+
+  std::ios::fmtflags flags = G4cout.flags();
+  std::streamsize precision = G4cout.precision(3);
+  G4cout << std::fixed << G4endl
+         << " Step profile: " << nofSteps << " steps, " << time
+         << " s sampled (1 step in " << fSamplingPeriod << ")" << G4endl
+         << std::left << std::setw(16) << " Volume" << std::setw(14)
+         << "Particle" << std::setw(16) << "Process" << std::right
+         << std::setw(13) << "steps" << std::setw(11) << "tracks"
+         << std::setw(10) << "time [s]" << std::setw(8) << "time %"
+         << std::setw(10) << "ns/step" << G4endl;
+  size_t nbRows = std::min(rows.size(), size_t(fNbRows));
+  for (size_t i = 0; i < nbRows; ++i) {
+    const std::vector<G4String>& names = rows[i].first;
+    const Totals& totals = rows[i].second;
+    G4cout << " " << std::left << std::setw(15) << names[0]
+           << std::setw(14) << names[1] << std::setw(16) << names[2]
+           << std::right << std::setw(13) << totals.nofSteps
+           << std::setw(11) << totals.nofTracks
+           << std::setw(10) << totals.time
+           << std::setw(8) << (time > 0. ? 100.*totals.time/time : 0.)
+           << std::setw(10) << 1.e9*totals.time/totals.nofSteps << G4endl;
+  }
+  if (nbRows < rows.size()) {
+    G4cout << " ... " << rows.size() - nbRows << " more rows" << G4endl;
+  }
+  G4cout.flags(flags);
+  G4cout.precision(precision);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
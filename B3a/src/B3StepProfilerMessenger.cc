@@ -0,0 +1,98 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3StepProfilerMessenger.cc
+/// \brief Implementation of the B3StepProfilerMessenger class
+
+#include "B3StepProfilerMessenger.hh"
+#include "B3StepProfiler.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3StepProfilerMessenger::B3StepProfilerMessenger(B3StepProfiler* profiler)
+ : G4UImessenger(),
+   fProfiler(profiler),
+   fDirectory(0),
+   fEnableCmd(0),
+   fSamplingPeriodCmd(0),
+   fNbRowsCmd(0)
+{
+  fDirectory = new G4UIdirectory("/B3/profile/");
+  fDirectory->SetGuidance("Steps and time by volume, particle and process.");
+
+  fEnableCmd = new G4UIcmdWithABool("/B3/profile/enable",this);
+  fEnableCmd->SetGuidance("Count the steps, tracks and sampled time and");
+  fEnableCmd->SetGuidance("print them ranked by time at the end of the run.");
+  fEnableCmd->SetParameterName("flag",true);
+  fEnableCmd->SetDefaultValue(true);
+  fEnableCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fSamplingPeriodCmd =
+    new G4UIcmdWithAnInteger("/B3/profile/samplingPeriod",this);
+  fSamplingPeriodCmd->SetGuidance("Time one step in nbSteps.");
+  fSamplingPeriodCmd->SetParameterName("nbSteps",false);
+  fSamplingPeriodCmd->SetRange("nbSteps>0");
+  fSamplingPeriodCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fNbRowsCmd = new G4UIcmdWithAnInteger("/B3/profile/nbRows",this);
+  fNbRowsCmd->SetGuidance("Number of rows of the printed table.");
+  fNbRowsCmd->SetParameterName("nbRows",false);
+  fNbRowsCmd->SetRange("nbRows>0");
+  fNbRowsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3StepProfilerMessenger::~B3StepProfilerMessenger()
+{
+  delete fEnableCmd;
+  delete fSamplingPeriodCmd;
+  delete fNbRowsCmd;
+  delete fDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3StepProfilerMessenger::SetNewValue(G4UIcommand* command,
+                                          G4String newValue)
+{
+  if ( command == fEnableCmd ) {
+    fProfiler->SetEnabled(fEnableCmd->GetNewBoolValue(newValue));
+  }
+  else if ( command == fSamplingPeriodCmd ) {
+    fProfiler->SetSamplingPeriod(
+      fSamplingPeriodCmd->GetNewIntValue(newValue));
+  }
+  else if ( command == fNbRowsCmd ) {
+    fProfiler->SetNbRows(fNbRowsCmd->GetNewIntValue(newValue));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,109 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3ThreadTimes.cc
+/// \brief Implementation of the B3ThreadTimes class
+
+#include "B3ThreadTimes.hh"
+
+#include "G4AutoLock.hh"
+
+#include <algorithm>
+#include <iomanip>
+
+G4Mutex B3ThreadTimes::fgMutex = G4MUTEX_INITIALIZER;
+std::vector<B3ThreadTimes::Record> B3ThreadTimes::fgRecords;
+B3ThreadTimes::Clock::time_point B3ThreadTimes::fgRunStart;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ThreadTimes::B3ThreadTimes()
+ : fBusy(0.),
+   fNofEvents(0),
+   fNofChunks(0),
+   fLastEventID(-2)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3ThreadTimes::~B3ThreadTimes()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ThreadTimes::BeginOfRun(G4bool master)
+{
+  fBusy = 0.;
+  fNofEvents = 0;
+  fNofChunks = 0;
+  fLastEventID = -2;
+  if (master) {
+    fgRecords.clear();
+    fgRunStart = Clock::now();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ThreadTimes::EndOfRun(G4bool tracking)
+{
+  if (!tracking) return;
+  Record record = { std::max(G4Threading::G4GetThreadId(), 0),
+                    fNofEvents, fNofChunks, fBusy };
+  G4AutoLock lock(&fgMutex);
+  fgRecords.push_back(record);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3ThreadTimes::Report() const
+{
+  if (fgRecords.empty()) return;
+
+  std::chrono::duration<G4double> wall = Clock::now() - fgRunStart;
+  std::sort(fgRecords.begin(), fgRecords.end());
+
+  G4double busy = 0.;
+  std::ios::fmtflags flags = G4cout.flags();
+  std::streamsize precision = G4cout.precision(3);
+  G4cout << std::fixed << G4endl
+         << " Thread   events   chunks   busy [s]   idle [s]" << G4endl;
+  for (size_t i = 0; i < fgRecords.size(); ++i) {
+    const Record& record = fgRecords[i];
+    busy += record.busy;
+    G4cout << std::setw(7) << record.thread
+           << std::setw(9) << record.nofEvents
+           << std::setw(9) << record.nofChunks
+           << std::setw(11) << record.busy
+           << std::setw(11) << wall.count() - record.busy << G4endl;
+  }
+  G4cout << " Run wall time " << wall.count() << " s, efficiency "
+         << 100.*busy/(fgRecords.size()*wall.count()) << " %" << G4endl;
+  G4cout.flags(flags);
+  G4cout.precision(precision);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
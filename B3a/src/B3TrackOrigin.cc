@@ -0,0 +1,84 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3TrackOrigin.cc
+/// \brief Implementation of the B3TrackOrigin class
+
+#include "B3TrackOrigin.hh"
+
+#include "G4Track.hh"
+#include "G4Gamma.hh"
+#include "G4VProcess.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Region.hh"
+#include "G4EmProcessSubType.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3TrackOrigin* B3TrackOrigin::Instance()
+{
+  static G4ThreadLocal B3TrackOrigin* instance = 0;
+  if (!instance) instance = new B3TrackOrigin();
+  return instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3TrackOrigin::B3TrackOrigin()
+ : fFlags()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3TrackOrigin::Tag(const G4Track* track)
+{
+  G4int trackID = track->GetTrackID();
+  if (size_t(trackID) >= fFlags.size()) fFlags.resize(2*trackID + 64, 0);
+
+  G4int parentID = track->GetParentID();
+  if (parentID == 0) {
+    fFlags[trackID] = kPrimary;
+    return;
+  }
+
+  G4int flags = GetFlags(parentID);
+  const G4VProcess* creator = track->GetCreatorProcess();
+  if (track->GetDefinition() == G4Gamma::Gamma() &&
+      !(creator && creator->GetProcessSubType() == fBremsstrahlung)) {
+    flags = kFluorescence;
+    // secondaries carry the touchable of the step that made them
+    const G4VPhysicalVolume* volume = track->GetVolume();
+    G4String region =
+      volume ? volume->GetLogicalVolume()->GetRegion()->GetName() : "";
+    if (region == "MoSolution")    flags |= kMoSolution;
+    else if (region == "Patient")  flags |= kPatient;
+    else if (region == "Detector") flags |= kDetector;
+  }
+  fFlags[trackID] = flags;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,80 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3VoxelParameterisation.cc
+/// \brief Implementation of the B3VoxelParameterisation class
+
+#include "B3VoxelParameterisation.hh"
+#include "B3VoxelPhantom.hh"
+
+#include "G4Material.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3VoxelParameterisation::B3VoxelParameterisation(const B3VoxelPhantom* phantom)
+ : G4PhantomParameterisation(),
+   fPhantom(phantom),
+   fScanner(phantom)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3VoxelParameterisation::~B3VoxelParameterisation()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4Material* B3VoxelParameterisation::ComputeMaterial(const G4int copyNo,
+                                                     G4VPhysicalVolume*,
+                                                     const G4VTouchable*)
+{
+  G4Material* material = fPhantom->GetVoxelMaterial(copyNo);
+  if (!material) {
+    G4ExceptionDescription msg;
+    msg << "Voxel " << copyNo << " has a material index or a Mo level"
+        << " missing from the material file.";
+    G4Exception("B3VoxelParameterisation::ComputeMaterial()",
+                "MyCode0005", FatalException, msg);
+  }
+  return material;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int B3VoxelParameterisation::MaterialScanner::GetNumberOfMaterials() const
+{
+  return fPhantom->GetMaterials().size();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4Material* 
+B3VoxelParameterisation::MaterialScanner::GetMaterial(G4int index) const
+{
+  return fPhantom->GetMaterials()[index];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,358 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3VoxelPhantom.cc
+/// \brief Implementation of the B3VoxelPhantom class
+
+#include "B3VoxelPhantom.hh"
+#include "B3VoxelParameterisation.hh"
+#include "B3DetectorConstruction.hh"
+
+#include "G4NistManager.hh"
+#include "G4Material.hh"
+#include "G4Box.hh"
+#include "G4LogicalVolume.hh"
+#include "G4PVPlacement.hh"
+#include "G4PVParameterised.hh"
+#include "G4VisAttributes.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+  // read-only shared mapping of a raw file of exactly size bytes
+  const unsigned char* MapFile(const G4String& fileName, size_t size)
+  {
+    G4ExceptionDescription msg;
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+      msg << "Cannot open the voxel file " << fileName;
+      G4Exception("B3VoxelPhantom::Construct()", "MyCode0005",
+                  FatalException, msg);
+      return 0;
+    }
+    struct stat st = {};
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) != size) {
+      close(fd);
+      msg << "The voxel file " << fileName << " has " << st.st_size
+          << " bytes, expected one byte per voxel (" << size << ")";
+      G4Exception("B3VoxelPhantom::Construct()", "MyCode0005",
+                  FatalException, msg);
+      return 0;
+    }
+    void* data = mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+      msg << "Cannot map the voxel file " << fileName;
+      G4Exception("B3VoxelPhantom::Construct()", "MyCode0005",
+                  FatalException, msg);
+      return 0;
+    }
+    return static_cast<const unsigned char*>(data);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3VoxelPhantom::B3VoxelPhantom()
+ : fVoxelSize(0.1*mm, 0.1*mm, 0.1*mm),
+   fIndex(0),
+   fMoMap(0),
+   fMappedSize(0),
+   fMass(0.),
+   fVoxelLV(0),
+   fParameterisation(0)
+{
+  fNbVoxels[0] = fNbVoxels[1] = fNbVoxels[2] = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3VoxelPhantom::~B3VoxelPhantom()
+{
+  UnmapFiles();
+  delete fParameterisation;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3VoxelPhantom::SetNbVoxels(G4int nx, G4int ny, G4int nz)
+{
+  fNbVoxels[0] = nx;
+  fNbVoxels[1] = ny;
+  fNbVoxels[2] = nz;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreeVector B3VoxelPhantom::GetHalfSize() const
+{
+  return G4ThreeVector(0.5*fNbVoxels[0]*fVoxelSize.x(),
+                       0.5*fNbVoxels[1]*fVoxelSize.y(),
+                       0.5*fNbVoxels[2]*fVoxelSize.z());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4LogicalVolume* B3VoxelPhantom::Construct(G4LogicalVolume* motherLV)
+{
+  Load();
+
+  //
+  // container
+  //
+  G4ThreeVector halfSize = GetHalfSize();
+  G4Box* solidPatient =
+    new G4Box("Patient", halfSize.x(), halfSize.y(), halfSize.z());
+
+  G4LogicalVolume* logicPatient =
+    new G4LogicalVolume(solidPatient,        //its solid
+                        fMaterials[0],       //its material
+                        "PatientLV");        //its name
+
+  G4VPhysicalVolume* physPatient =
+    new G4PVPlacement(0,                     //no rotation
+                      G4ThreeVector(),       //at (0,0,0)
+                      logicPatient,          //its logical volume
+                      "Patient",             //its name
+                      motherLV,              //its mother  volume
+                      false,                 //no boolean operation
+                      0,                     //copy number
+                      false);                // overlaps checked later
+
+  PlaceVoxels(physPatient);
+
+  return logicPatient;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3VoxelPhantom::Load()
+{
+  if (fNbVoxels[0] <= 0 || fNbVoxels[1] <= 0 || fNbVoxels[2] <= 0 ||
+      fVoxelSize.x() <= 0. || fVoxelSize.y() <= 0. || fVoxelSize.z() <= 0.) {
+    G4ExceptionDescription msg;
+    msg << "The number of voxels and the voxel size must be set"
+        << " with /B3/det/phantom/nbVoxels and /B3/det/phantom/voxelSize";
+    G4Exception("B3VoxelPhantom::Construct()", "MyCode0005",
+                FatalException, msg);
+  }
+
+  // map the voxel data; a rebuilt geometry maps the files again
+  //
+  UnmapFiles();
+  size_t nbVoxels = GetNbVoxels();
+  fIndex = MapFile(fIndexFile, nbVoxels);
+  if (!fMoMapFile.empty()) fMoMap = MapFile(fMoMapFile, nbVoxels);
+  fMappedSize = nbVoxels;
+
+  ReadMaterialFile();
+  ComputeMass();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3VoxelPhantom::ComputeMass()
+{
+  // voxels per (index, level), then the mass of the phantom
+  size_t nbVoxels = GetNbVoxels();
+  std::vector<size_t> counts(256*256, 0);
+  for (size_t i = 0; i < nbVoxels; ++i) {
+    size_t level = fMoMap ? fMoMap[i] : 0;
+    ++counts[(size_t(fIndex[i]) << 8) | level];
+  }
+  G4double voxelVolume = fVoxelSize.x()*fVoxelSize.y()*fVoxelSize.z();
+  fMass = 0.;
+  for (size_t key = 0; key < counts.size(); ++key) {
+    if (counts[key] == 0) continue;
+    if (!fMaterialTable[key]) {
+      G4ExceptionDescription msg;
+      msg << "Material index " << (key >> 8) << " or Mo level " << (key & 0xff)
+          << " of " << fIndexFile << " missing from " << fMaterialFile;
+      G4Exception("B3VoxelPhantom::Construct()", "MyCode0005",
+                  FatalException, msg);
+      return;
+    }
+    fMass += counts[key]*voxelVolume*fMaterialTable[key]->GetDensity();
+  }
+
+  // a uniform dose in the voxels must be the dose of the patient
+  G4double dose = 0.;
+  for (size_t i = 0; i < nbVoxels; ++i) dose += GetPatientDose(i, 1.*gray);
+  if (std::abs(dose/gray - 1.) > 1.e-6) {
+    G4ExceptionDescription msg;
+    msg << "A uniform 1 Gy in the voxels gives a patient dose of "
+        << dose/gray << " Gy.";
+    G4Exception("B3VoxelPhantom::Construct()", "MyCode0005",
+                FatalException, msg);
+  }
+  G4cout << "Voxel phantom: " << nbVoxels << " voxels, "
+         << fMass/kg << " kg" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3VoxelPhantom::PlaceVoxels(G4VPhysicalVolume* physPatient)
+{
+  G4LogicalVolume* logicPatient = physPatient->GetLogicalVolume();
+  size_t nbVoxels = GetNbVoxels();
+
+  G4ThreeVector halfVoxel = 0.5*fVoxelSize;
+  G4Box* solidVoxel =
+    new G4Box("Voxel", halfVoxel.x(), halfVoxel.y(), halfVoxel.z());
+  fVoxelLV = new G4LogicalVolume(solidVoxel, fMaterials[0], "VoxelLV");
+
+  delete fParameterisation;
+  fParameterisation = new B3VoxelParameterisation(this);
+  fParameterisation->SetVoxelDimensions(halfVoxel.x(), halfVoxel.y(),
+                                        halfVoxel.z());
+  fParameterisation->SetNoVoxel(fNbVoxels[0], fNbVoxels[1], fNbVoxels[2]);
+  fParameterisation->SetMaterials(fMaterials);
+  fParameterisation->BuildContainerSolid(physPatient);
+  G4ThreeVector halfSize = GetHalfSize();
+  fParameterisation->CheckVoxelsFillContainer(halfSize.x(), halfSize.y(),
+                                              halfSize.z());
+
+  G4PVParameterised* physVoxels =
+    new G4PVParameterised("Voxels",          //its name
+                          fVoxelLV,          //its logical volume
+                          logicPatient,      //its mother volume
+                          kUndefined,        //no optimisation axis
+                          nbVoxels,          //number of voxels
+                          fParameterisation);//its parameterisation
+  physVoxels->SetRegularStructureId(1);
+
+  fVoxelLV->SetVisAttributes(G4VisAttributes::GetInvisible());
+
+  G4cout << "\nVoxel phantom: " << fNbVoxels[0] << " x " << fNbVoxels[1]
+         << " x " << fNbVoxels[2] << " voxels of "
+         << fVoxelSize.x()/mm << " x " << fVoxelSize.y()/mm << " x "
+         << fVoxelSize.z()/mm << " mm3, "
+         << fMaterials.size() << " materials" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3VoxelPhantom::ReadMaterialFile()
+{
+  std::ifstream input(fMaterialFile);
+  if (!input) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open the material file " << fMaterialFile;
+    G4Exception("B3VoxelPhantom::ReadMaterialFile()", "MyCode0005",
+                FatalException, msg);
+    return;
+  }
+
+  // level 0 is the tissue without Mo, unless given a concentration;
+  // a negative concentration marks an undeclared level
+  std::vector<G4Material*> tissues(256, 0);
+  std::vector<G4double> concentrations(256, -1.);
+  concentrations[0] = 0.;
+
+  G4NistManager* nist = G4NistManager::Instance();
+  std::string line;
+  while (std::getline(input, line)) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream is(line);
+    std::string key;
+    if (!(is >> key)) continue;
+
+    G4int index = -1;
+    G4bool ok = false;
+    if (key == "Mo") {
+      G4double concentration;
+      ok = (is >> index >> concentration) && index >= 0 && index < 256;
+      if (ok) concentrations[index] = concentration*mg/cm3;
+    }
+    else {
+      std::string name;
+      ok = (std::istringstream(key) >> index) && (is >> name)
+           && index >= 0 && index < 256;
+      if (ok) {
+        tissues[index] = nist->FindOrBuildMaterial(name);
+        ok = tissues[index] != 0;
+      }
+    }
+    if (!ok) {
+      G4ExceptionDescription msg;
+      msg << "Bad line in the material file " << fMaterialFile << ":\n"
+          << line;
+      G4Exception("B3VoxelPhantom::ReadMaterialFile()", "MyCode0005",
+                  FatalException, msg);
+    }
+  }
+
+  // one material per declared (index, level)
+  //
+  G4int nbLevels = fMoMap ? 256 : 1;
+  fMaterialTable.assign(256*256, 0);
+  fMaterials.clear();
+  for (G4int index = 0; index < 256; ++index) {
+    G4Material* tissue = tissues[index];
+    if (!tissue) continue;
+    for (G4int level = 0; level < nbLevels; ++level) {
+      if (concentrations[level] < 0.) continue;
+      std::ostringstream name;
+      name << tissue->GetName() << "_Mo" << level;
+      G4Material* material =
+        B3DetectorConstruction::BuildMoSolution(name.str(), tissue,
+                                                concentrations[level]);
+      fMaterialTable[(index << 8) | level] = material;
+      if (std::find(fMaterials.begin(), fMaterials.end(), material)
+          == fMaterials.end()) fMaterials.push_back(material);
+    }
+  }
+
+  if (fMaterials.empty()) {
+    G4ExceptionDescription msg;
+    msg << "No material defined in " << fMaterialFile;
+    G4Exception("B3VoxelPhantom::ReadMaterialFile()", "MyCode0005",
+                FatalException, msg);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3VoxelPhantom::UnmapFiles()
+{
+  if (fIndex) munmap(const_cast<unsigned char*>(fIndex), fMappedSize);
+  if (fMoMap) munmap(const_cast<unsigned char*>(fMoMap), fMappedSize);
+  fIndex = 0;
+  fMoMap = 0;
+  fMappedSize = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
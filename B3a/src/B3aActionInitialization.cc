@@ -30,13 +30,16 @@
 #include "B3aActionInitialization.hh"
 #include "B3aRunAction.hh"
 #include "B3aEventAction.hh"
+#include "B3aSteppingAction.hh"
+#include "B3aTrackingAction.hh"
 #include "B3PrimaryGeneratorAction.hh"
 #include "B3StackingAction.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-B3aActionInitialization::B3aActionInitialization()
- : G4VUserActionInitialization()
+B3aActionInitialization::B3aActionInitialization(const G4String& outputName)
+ : G4VUserActionInitialization(),
+   fOutputName(outputName)
 {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -48,18 +51,20 @@ B3aActionInitialization::~B3aActionInitialization()
 
 void B3aActionInitialization::BuildForMaster() const
 {
-  SetUserAction(new B3aRunAction);
+  SetUserAction(new B3aRunAction(fOutputName));
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void B3aActionInitialization::Build() const
 {
-  B3aRunAction* runAction = new B3aRunAction();
+  B3aRunAction* runAction = new B3aRunAction(fOutputName);
   SetUserAction(runAction);
 
   SetUserAction(new B3aEventAction(runAction));
-  SetUserAction(new B3PrimaryGeneratorAction);
+  SetUserAction(new B3aTrackingAction(runAction));
+  SetUserAction(new B3aSteppingAction(runAction));
+  SetUserAction(new B3PrimaryGeneratorAction(runAction));
   SetUserAction(new B3StackingAction);
 }  
 
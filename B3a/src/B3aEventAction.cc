@@ -29,7 +29,19 @@
 
 #include "B3aEventAction.hh"
 #include "B3aRunAction.hh"
-#include "MyAnalysis.hh"
+#include "B3PixelSD.hh"
+#include "B3DetectorConstruction.hh"
+#include "B3VoxelPhantom.hh"
+#include "B3ForcedDetection.hh"
+#include "B3DoseGrid.hh"
+#include "B3ListMode.hh"
+#include "B3SpectralCube.hh"
+#include "B3Checkpoint.hh"
+#include "B3Reproducibility.hh"
+#include "B3ThreadTimes.hh"
+#include "B3AutoStop.hh"
+#include "B3ResponseBuilder.hh"
+#include "B3Analysis.hh"
 
 #include "G4RunManager.hh"
 #include "G4Event.hh"
@@ -45,7 +57,8 @@
 B3aEventAction::B3aEventAction(B3aRunAction* runAction)
  : G4UserEventAction(), 
    fRunAction(runAction),
-   fCollID_cryst(-1),
+   fPixelSD(0),
+   fPhantom(0),
    fCollID_patient(-1)
 {}
 
@@ -56,8 +69,12 @@ B3aEventAction::~B3aEventAction()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void B3aEventAction::BeginOfEventAction(const G4Event* /*evt*/)
-{ }
+void B3aEventAction::BeginOfEventAction(const G4Event* evt)
+{
+  // the previous block of events is complete
+  fRunAction->GetReproducibility()->BeginOfEvent(evt->GetEventID());
+  fRunAction->GetThreadTimes()->BeginOfEvent();
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -68,44 +85,66 @@ void B3aEventAction::EndOfEventAction(const G4Event* evt )
   G4HCofThisEvent* HCE = evt->GetHCofThisEvent();
   if(!HCE) return;
                
-   // Get hits collections IDs
-  if (fCollID_cryst < 0) {
+   // Get pixel detector and hits collections IDs
+  if (!fPixelSD) {
     G4SDManager* SDMan = G4SDManager::GetSDMpointer();  
-    fCollID_cryst   = SDMan->GetCollectionID("crystal/edep");
+    fPixelSD = static_cast<B3PixelSD*>(SDMan->FindSensitiveDetector("crystal"));
     fCollID_patient = SDMan->GetCollectionID("patient/dose");    
+    fPhantom = static_cast<const B3DetectorConstruction*>(
+      G4RunManager::GetRunManager()->GetUserDetectorConstruction())
+      ->GetVoxelPhantom();
   }
   
-  //Energy in crystals : identify 'good events'
+  //Energy in pixels : identify 'good events'
   //
+  auto analysisManager = G4AnalysisManager::Instance();
+  B3ForcedDetection* forcedDetection = fRunAction->GetForcedDetection();
+  B3ListMode* listMode = fRunAction->GetListMode();
+  B3SpectralCube* spectralCube = fRunAction->GetSpectralCube();
+  B3AutoStop* autoStop = fRunAction->GetAutoStop();
+  const std::vector<G4int>& pixels = fPixelSD->GetTouchedPixels();
+  for (size_t i = 0; i < pixels.size(); ++i) {
+    G4int pixel = pixels[i];
+    G4double edep = fPixelSD->GetEdep(pixel);
 
-  G4THitsMap<G4double>* evtMap = 
-                     (G4THitsMap<G4double>*)(HCE->GetHC(fCollID_cryst));
-               
-  std::map<G4int,G4double*>::iterator itr;
-  for (itr = evtMap->GetMap()->begin(); itr != evtMap->GetMap()->end(); itr++) {
-    ///G4int copyNb  = (itr->first);
-    G4double edep = *(itr->second);
-    ///G4cout << "\n  cryst" << copyNb << ": " << edep/keV << " keV ";
-
-    if (edep != 0.) {
-        fRunAction->CountEvent();
-        // fill histogram
-        auto analysisManager = G4AnalysisManager::Instance();
-        analysisManager->FillH1(0, edep);
-    }
+    fRunAction->CountEvent();
+    // fill histograms
+    analysisManager->FillH1(0, edep);
+    analysisManager->FillH2(0, fPixelSD->GetCrystal(pixel), fPixelSD->GetRing(pixel));
+    forcedDetection->ScoreAnalog(pixel, edep);
+    spectralCube->Fill(pixel, edep);
+    autoStop->ScorePixel(edep);
+    listMode->AddRecord(evt->GetEventID(), pixel, edep,
+                        fPixelSD->GetTime(pixel), fPixelSD->GetFlags(pixel));
   }
+  forcedDetection->EndOfEvent();
+  fRunAction->GetDoseGrid()->EndOfEvent();
+  fRunAction->GetResponseBuilder()->EndOfEvent(evt, fPixelSD);
   
   //Dose deposit in patient
   //
   G4double dose = 0.;
      
-  evtMap = (G4THitsMap<G4double>*)(HCE->GetHC(fCollID_patient));
+  G4THitsMap<G4double>* evtMap = 
+                     (G4THitsMap<G4double>*)(HCE->GetHC(fCollID_patient));
                
+  // the voxel doses of a phantom are weighted by the voxel masses:
+  // the patient dose is their energy over the mass of the phantom
+  G4bool voxels = fPhantom->IsDefined();
+  std::map<G4int,G4double*>::iterator itr;
   for (itr = evtMap->GetMap()->begin(); itr != evtMap->GetMap()->end(); itr++) {
-    ///G4int copyNb  = (itr->first);
-    dose = *(itr->second);
+    G4int copyNb  = (itr->first);
+    G4double voxelDose = *(itr->second);
+    dose += voxels ? fPhantom->GetPatientDose(copyNb, voxelDose) : voxelDose;
   }
   if (dose > 0.) fRunAction->SumDose(dose);
+  autoStop->ScoreDose(dose);
+
+  // the event is complete in all the scorers
+  fRunAction->GetCheckpoint()->EndOfEvent(evt->GetEventID());
+  fRunAction->GetThreadTimes()->EndOfEvent(evt->GetEventID());
+  // last: may stop the event loop of this thread
+  autoStop->EndOfEvent(evt->GetEventID());
 }  
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
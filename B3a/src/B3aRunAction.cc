@@ -29,20 +29,50 @@
 
 #include "B3aRunAction.hh"
 #include "B3PrimaryGeneratorAction.hh"
-#include "MyAnalysis.hh"
+#include "B3DetectorConstruction.hh"
+#include "B3ForcedDetection.hh"
+#include "B3DoseGrid.hh"
+#include "B3ListMode.hh"
+#include "B3SpectralCube.hh"
+#include "B3Checkpoint.hh"
+#include "B3Reproducibility.hh"
+#include "B3ThreadTimes.hh"
+#include "B3StepProfiler.hh"
+#include "B3AutoStop.hh"
+#include "B3PhaseSpace.hh"
+#include "B3ResponseBuilder.hh"
+#include "B3Npy.hh"
+#include "B3Analysis.hh"
 
 #include "G4RunManager.hh"
 #include "G4Run.hh"
 #include "G4AccumulableManager.hh"
+#include "G4Threading.hh"
+#include "G4Timer.hh"
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
 
+#include <fstream>
+#include <sstream>
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-B3aRunAction::B3aRunAction()
+B3aRunAction::B3aRunAction(const G4String& outputName)
  : G4UserRunAction(),
+   fOutputName(outputName),
    fGoodEvents(0),
-   fSumDose(0.)  
+   fSumDose(0.),
+   fForcedDetection(0),
+   fDoseGrid(0),
+   fListMode(0),
+   fSpectralCube(0),
+   fCheckpoint(0),
+   fReproducibility(0),
+   fThreadTimes(0),
+   fStepProfiler(0),
+   fAutoStop(0),
+   fPhaseSpace(0),
+   fResponseBuilder(0)
 {  
   //add new units for dose
   // 
@@ -61,11 +91,27 @@ B3aRunAction::B3aRunAction()
   accumulableManager->RegisterAccumulable(fGoodEvents);
   accumulableManager->RegisterAccumulable(fSumDose);
 
+  // Optional scorers, registering their own accumulables
+  fForcedDetection = new B3ForcedDetection();
+  fDoseGrid = new B3DoseGrid();
+  fListMode = new B3ListMode();
+  fSpectralCube = new B3SpectralCube();
+  fCheckpoint = new B3Checkpoint();
+  fReproducibility = new B3Reproducibility();
+  fThreadTimes = new B3ThreadTimes();
+  fStepProfiler = new B3StepProfiler();
+  fAutoStop = new B3AutoStop();
+  fPhaseSpace = new B3PhaseSpace();
+  fResponseBuilder = new B3ResponseBuilder();
+
   auto analysisManager = G4AnalysisManager::Instance();
   G4cout << "Using " << analysisManager->GetType() << G4endl;
   analysisManager->SetVerboseLevel(1);
-  analysisManager->SetNtupleMerging(false);
-// Note: merging ntuples is available only with Root output
+  // histograms are always merged on the master;
+  // merging ntuples is available only with Root output
+  if (analysisManager->GetType() == "Root") {
+    analysisManager->SetNtupleMerging(true);
+  }
 
   // Book histograms, ntuple
   //
@@ -73,12 +119,32 @@ B3aRunAction::B3aRunAction()
   // Creating histograms
 
   analysisManager->CreateH1("E_tot","Energy deposited in whole detector", 24./0.025, 0., 24.*keV, "keV", "Energy");
+
+  const B3DetectorConstruction* detector
+    = static_cast<const B3DetectorConstruction*>(
+        G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  G4int nbCrystals = detector->GetNbCrystals();
+  G4int nbRings = detector->GetNbRings();
+  analysisManager->CreateH2("Pixels","Hits per pixel (crystal, ring)",
+                            nbCrystals, 0., nbCrystals, nbRings, 0., nbRings);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 B3aRunAction::~B3aRunAction()
-{ }
+{
+  delete fForcedDetection;
+  delete fDoseGrid;
+  delete fListMode;
+  delete fSpectralCube;
+  delete fCheckpoint;
+  delete fReproducibility;
+  delete fThreadTimes;
+  delete fStepProfiler;
+  delete fAutoStop;
+  delete fPhaseSpace;
+  delete fResponseBuilder;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -89,6 +155,24 @@ void B3aRunAction::BeginOfRunAction(const G4Run* run)
   // reset accumulables to their initial values
   G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
   accumulableManager->Reset();
+  fReproducibility->BeginOfRun(run->GetRunID(), IsMaster());
+  fThreadTimes->BeginOfRun(IsMaster());
+  fStepProfiler->BeginOfRun(IsMaster());
+  fAutoStop->BeginOfRun(IsMaster());
+
+  G4bool tracking = !IsMaster() || !G4Threading::IsMultithreadedApplication();
+  fForcedDetection->BeginOfRun(tracking);
+  fDoseGrid->BeginOfRun();
+  fSpectralCube->BeginOfRun();
+  // one set of output files per run
+  std::ostringstream runName;
+  runName << fOutputName;
+  if (run->GetRunID() > 0) runName << "_run" << run->GetRunID();
+  fRunName = runName.str();
+
+  fPhaseSpace->BeginOfRun(fRunName, run->GetNumberOfEventToBeProcessed(),
+                          IsMaster(), tracking);
+  fResponseBuilder->BeginOfRun(IsMaster());
   
   //inform the runManager to save random number seed
   G4RunManager::GetRunManager()->SetRandomNumberStore(false);
@@ -101,17 +185,61 @@ void B3aRunAction::BeginOfRunAction(const G4Run* run)
   // Get analysis manager
   auto analysisManager = G4AnalysisManager::Instance();
 
-  G4String fileName = "Test";
+  // the pixel histogram follows a geometry rebuilt with /B3/det/...
+  const B3DetectorConstruction* detector
+    = static_cast<const B3DetectorConstruction*>(
+        G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  G4int nbCrystals = detector->GetNbCrystals();
+  G4int nbRings = detector->GetNbRings();
+  analysisManager->SetH2(0, nbCrystals, 0., nbCrystals, nbRings, 0., nbRings);
+
+  analysisManager->OpenFile(fRunName);
+
+  // add the checkpoints of an interrupted run
+  // to the accumulables and histograms just reset
+  if (fReproducibility->IsEnabled() && fCheckpoint->IsEnabled()) {
+    if (IsMaster()) {
+      G4Exception("B3aRunAction::BeginOfRunAction()", "MyCode0008",
+                  JustWarning,
+                  "Checkpoints are disabled in the reproducible mode.");
+    }
+    fCheckpoint->SetEnabled(false);
+  }
+  fCheckpoint->BeginOfRun(fRunName, run->GetNumberOfEventToBeProcessed(),
+                          IsMaster(), tracking, fListMode->IsEnabled());
 
-  analysisManager->OpenFile(fileName);
+  // after the checkpoints, which refuse to resume over list-mode files
+  if (tracking) {
+    std::ostringstream fileName;
+    fileName << fRunName << "_lm";
+    if (G4Threading::IsWorkerThread()) {
+      fileName << "_t" << G4Threading::G4GetThreadId();
+    }
+    fileName << ".bin";
+    fListMode->BeginOfRun(fileName.str());
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void B3aRunAction::EndOfRunAction(const G4Run* run)
 {
+  fListMode->EndOfRun();
+  fPhaseSpace->EndOfRun(run->GetNumberOfEvent());
+  // the ordered sums, before the merge of the accumulables and histograms
+  fReproducibility->EndOfRun(IsMaster());
+  G4bool tracking = !IsMaster() || !G4Threading::IsMultithreadedApplication();
+  fThreadTimes->EndOfRun(tracking);
+  fStepProfiler->EndOfRun(tracking);
+  fAutoStop->EndOfRun(tracking);
+  fResponseBuilder->EndOfRun(IsMaster(), tracking);
+
+  auto analysisManager = G4AnalysisManager::Instance();
   G4int nofEvents = run->GetNumberOfEvent();
-  if (nofEvents == 0) return;
+  if (nofEvents == 0) {
+    analysisManager->CloseFile();
+    return;
+  }
   
   // Merge accumulables 
   G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
@@ -131,16 +259,29 @@ void B3aRunAction::EndOfRunAction(const G4Run* run)
     partName = particle->GetParticleName();
   }  
 
-  // save histograms & ntuple
-
-  auto analysisManager = G4AnalysisManager::Instance();
+  // save histograms & ntuple;
+  // the workers merge their histograms into the master ones
+  G4Timer timer;
+  timer.Start();
   analysisManager->Write();
+  if (IsMaster()) WriteHistograms();   // before CloseFile() resets them
   analysisManager->CloseFile();
+  timer.Stop();
 
   // Print results
   //
   if (IsMaster())
   {
+    G4cout << " Histograms written in "
+           << timer.GetRealElapsed()*1000. << " ms" << G4endl;
+    fForcedDetection->Write(fRunName + "_fd.npy", nofEvents);
+    fDoseGrid->Write(fRunName + "_dose.npy", nofEvents);
+    fSpectralCube->Write(fRunName + "_cube.npy");
+    // the events behind the outputs, which a merge weights them with
+    std::ofstream events((fRunName + ".events").c_str());
+    events << nofEvents << std::endl;
+    fCheckpoint->EndOfRun(true);
+
     G4cout
      << G4endl
      << "--------------------End of Global Run-----------------------"
@@ -161,6 +302,39 @@ void B3aRunAction::EndOfRunAction(const G4Run* run)
      << G4endl 
      << "------------------------------------------------------------" << G4endl 
      << G4endl;
+
+  // scaling efficiency of the event loop, profile of the steps,
+  // uncertainties of a stopped run
+  if (IsMaster()) {
+    fThreadTimes->Report();
+    fStepProfiler->Report();
+    fAutoStop->Report();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3aRunAction::WriteHistograms() const
+{
+  // bin contents with underflow and overflow, as stored by the tools
+  // histograms: h1 shape (nx+2), h2 shape (ny+2, nx+2)
+  auto analysisManager = G4AnalysisManager::Instance();
+  for (G4int id = 0; id < analysisManager->GetNofH1s(); ++id) {
+    G4H1* h1 = analysisManager->GetH1(id);
+    if (!h1) continue;
+    std::vector<size_t> shape(1, h1->axis().bins() + 2);
+    B3Npy::Write(fRunName + "_h1_" + analysisManager->GetH1Name(id) + ".npy",
+                 shape, &h1->bins_sum_w()[0]);
+  }
+  for (G4int id = 0; id < analysisManager->GetNofH2s(); ++id) {
+    G4H2* h2 = analysisManager->GetH2(id);
+    if (!h2) continue;
+    std::vector<size_t> shape;
+    shape.push_back(h2->axis_y().bins() + 2);
+    shape.push_back(h2->axis_x().bins() + 2);
+    B3Npy::Write(fRunName + "_h2_" + analysisManager->GetH2Name(id) + ".npy",
+                 shape, &h2->bins_sum_w()[0]);
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,65 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B3aSteppingAction.cc
+/// \brief Implementation of the B3aSteppingAction class
+
+#include "B3aSteppingAction.hh"
+#include "B3aRunAction.hh"
+#include "B3ForcedDetection.hh"
+#include "B3DoseGrid.hh"
+#include "B3StepProfiler.hh"
+#include "B3PhaseSpace.hh"
+
+#include "G4Step.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3aSteppingAction::B3aSteppingAction(B3aRunAction* runAction)
+ : G4UserSteppingAction(),
+   fRunAction(runAction)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+B3aSteppingAction::~B3aSteppingAction()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void B3aSteppingAction::UserSteppingAction(const G4Step* step)
+{
+  B3ForcedDetection* forcedDetection = fRunAction->GetForcedDetection();
+  if (forcedDetection->IsEnabled()) forcedDetection->ProcessStep(step);
+
+  fRunAction->GetDoseGrid()->ProcessStep(step);
+  fRunAction->GetPhaseSpace()->ProcessStep(step);
+
+  // last, so the time of a step includes the user actions above
+  fRunAction->GetStepProfiler()->ProcessStep(step);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......